@@ -0,0 +1,116 @@
+#!/bin/bash
+#
+# Copyright (C) 2012-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+: ${BEE_BINDIR=/usr/bin}
+: ${BEE_LIBEXECDIR=/usr/libexec}
+
+set -e
+
+if [ -z "${BEE_VERSION}" ] ; then
+    echo >&2 "BEE-ERROR: please don't call $0 directly without initializing the environment.."
+    exit 1
+fi
+
+function print_info()
+{
+    echo "${@}"
+}
+
+function create_pkgbcfile()
+{
+    local PKGALLPKG=${1}
+    local PKGMETADIR=${BEE_METADIR}/${PKGALLPKG}
+    local CONTENTFILE=${PKGMETADIR}/CONTENT
+    local PKGBCFILE=${CACHEDIR}/${PKGALLPKG}.bc
+    local PKGBCRFILE=${PKGBCFILE%.bc}.bcr
+
+    local tmpfile=${PKGBCFILE}.tmp.$$
+
+    if [ ! -d "${PKGMETADIR}" ] ; then
+        # cleanup cache if metadir does not exist
+        rm -f "${PKGBCFILE}" "${PKGBCRFILE}"
+        return 0
+    elif [ ! -e "${CONTENTFILE}" ] ; then
+        if [ -e "${PKGBCFILE}" ] ; then
+            print_info "moving ${PKGBCFILE} to ${PKGBCRFILE}.."
+            mv "${PKGBCFILE}" "${PKGBCRFILE}"
+            return 0
+        elif [ -e "${PKGBCRFILE}" ] ; then
+            return 0
+        elif [ -e "${CONTENTFILE}.bee-remove" ] ; then
+            CONTENTFILE=${CONTENTFILE}.bee-remove
+            PKGBCFILE=${PKGBCRFILE}
+            tmpfile=${PKGBCFILE}.tmp.$$
+        else
+           return 0
+        fi
+    fi
+
+    print_info "creating ${PKGBCFILE} .."
+    if ! ${BEE_LIBEXECDIR}/bee/bee-cache-inventory \
+            --sorted \
+            --prepend "${PKGALLPKG} " \
+            ${CONTENTFILE} \
+            >${tmpfile} ; then
+        echo >&2 "bee-cache-update: ${tmpfile}: Creation failed."
+        rm ${tmpfile}
+        return 1
+    fi
+
+    mv ${tmpfile} ${PKGBCFILE}
+}
+
+function update_inventory()
+{
+    if [ ! -d "${BEE_METADIR}" ] ; then
+        print_info "creating ${INVENTORYFILE} .."
+        touch ${INVENTORYFILE}
+        return 0
+    fi
+
+    # only packages whose CONTENT changed since ${CACHEDIR}/MANIFEST was
+    # written are inventoried again, the given ones get a new cache file
+    if ! ${BEE_LIBEXECDIR}/bee/bee-cache-inventory \
+            --cache ${CACHEDIR} \
+            --tmpfile \
+            --jobs 0 \
+            --index \
+            ${BEE_METADIR} "${@}" ; then
+        echo >&2 "bee-cache-update: ${INVENTORYFILE}: Update failed."
+        return 1
+    fi
+}
+
+declare -a pkgs=( "${@}" )
+declare CACHEDIR=${BEE_CACHEDIR}/bee-cache
+declare INVENTORYFILE=${CACHEDIR}/INVENTORY
+
+mkdir -p ${CACHEDIR}
+
+if [ "${pkgs[0]}" == "PKGS" ] ; then
+    for p in ${BEE_METADIR}/* ; do
+        create_pkgbcfile ${p##*/}
+    done
+    exit 0
+fi
+
+update_inventory "${pkgs[@]}"
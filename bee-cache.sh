@@ -0,0 +1,324 @@
+#!/bin/bash
+#
+# bee-cache - manage inventory
+#
+# Copyright (C) 2012-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+if [ -z "${BEE_VERSION}" ] ; then
+    echo >&2 "BEE-ERROR: please call $0 from bee .."
+    exit 1
+fi
+
+VERSION=${BEE_VERSION}
+
+: ${BEE_BINDIR:=/usr/bin}
+: ${BEEFLOCK=${BEE_BINDIR}/beeflock}
+: ${BEECACHE_CACHEDIR=${BEE_CACHEDIR}/bee-cache}
+: ${BEECACHE_INVENTORY=${BEECACHE_CACHEDIR}/INVENTORY}
+
+function cache_verify() {
+    # one stat per package compared to the manifest of the last update
+    if ${BEEFLOCK} --shared "${BEECACHE_INVENTORY}" \
+              ${BEE_LIBEXECDIR}/bee/bee-cache-inventory --check \
+                  --cache "${BEECACHE_CACHEDIR}" "${BEE_METADIR}" \
+                  >/dev/null 2>&1 ; then
+        return
+    fi
+
+    cache_rebuild
+}
+
+function cache_rebuild() {
+    mkdir -p "${BEECACHE_CACHEDIR}"
+
+    ${BEEFLOCK} ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-update >/dev/null
+}
+
+function cache_update() {
+    ${BEEFLOCK} ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-update "${@}" \
+        >/dev/null
+
+    if [ $? -ne 0 ] ; then
+        echo >&2 "bee-cache: ${*}: Updating inventory failed."
+        return 1
+    fi
+
+    return 0
+}
+
+function cache_grep() {
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        grep "${@}" ${BEECACHE_INVENTORY}
+}
+
+function cache_query() {
+    # a missing or stale index is rebuilt under the exclusive lock so
+    # concurrent readers never race to write it
+    ${BEEFLOCK} ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-query \
+            --update --inventory ${BEECACHE_INVENTORY} index || return
+
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-query \
+            --inventory ${BEECACHE_INVENTORY} "${@}"
+}
+
+function print_conflicts() {
+    local pkg=${1}
+
+    if [ -z "${pkg}" ] ; then
+        echo >&2 "bee-cache: print-conflicts: No package provided."
+        return 1
+    fi
+
+    # inventory lines of other packages conflicting with ${pkg} sorted by
+    # package and path: -f1,8- are the conflicting package and the path
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-inventory --merge --conflicts "${pkg}" \
+            ${BEECACHE_INVENTORY} "${TMPINSTALL[@]}"
+}
+
+function print_conflicting_files() {
+    local pkg=$1
+
+    if [ -z "${pkg}" ] ; then
+        echo >&2 "bee-cache: print-conflicting-files: No package provided."
+        return 1
+    fi
+
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-inventory --merge --conflicting-files "${pkg}" \
+            ${BEECACHE_INVENTORY} "${TMPINSTALL[@]}"
+}
+
+function print_uniq_files() {
+    local pkg=$1
+
+    if [ -z "${pkg}" ] ; then
+        echo >&2 "bee-cache: print-uniq-files: no package provided."
+        return 1
+    fi
+
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-inventory --merge --unique "${pkg}" \
+            ${BEECACHE_INVENTORY} "${TMPINSTALL[@]}"
+}
+
+function remove_uniq_files() {
+    local pkg=$1
+
+    if [ -z "${pkg}" ] ; then
+        echo >&2 "bee-cache: remove-uniq-files: no package provided."
+        return 1
+    fi
+
+    # removes deepest first and prints the lines of the removed files
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-inventory --merge --unique "${pkg}" --unlink \
+            ${BEECACHE_INVENTORY} "${TMPINSTALL[@]}"
+}
+
+function print_missing_files() {
+    local pkg=$1
+
+    # lookups of many files are kept in flight by one thread per cpu
+    ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} \
+        ${BEE_LIBEXECDIR}/bee/bee-cache-inventory --merge --missing \
+            ${pkg:+--package "${pkg}"} --jobs 0 \
+            ${BEECACHE_INVENTORY} "${TMPINSTALL[@]}"
+}
+
+function tmp_merge_install_inventory_files() {
+    LC_ALL=C ${BEEFLOCK} --shared ${BEECACHE_INVENTORY} sort -m -u -r -k8 -k1 \
+        ${BEECACHE_INVENTORY} "${@}"
+}
+
+function tmpinstall_to_filenames() {
+    local -a fn
+
+    for f in "${TMPINSTALL[@]}" ; do
+        if [ -f "${f}" ] ; then
+            fn=( "${fn[@]}" "$f" )
+            continue
+        fi
+
+        if [ -e "${BEECACHE_CACHEDIR}/${f}.bc" ] ; then
+            fn=( "${fn[@]}" "${BEECACHE_CACHEDIR}/${f}.bc" )
+            continue
+        fi
+
+        if [ -e "${BEECACHE_CACHEDIR}/${f}.bcr" ] ; then
+            fn=( "${fn[@]}" "${BEECACHE_CACHEDIR}/${f}.bcr" )
+            continue
+        fi
+
+        cache_update "${f}"
+
+        if [ -e "${BEECACHE_CACHEDIR}/${f}.bc" ] ; then
+            fn=( "${fn[@]}" "${BEECACHE_CACHEDIR}/${f}.bc" )
+            continue
+        fi
+
+        if [ -e "${BEECACHE_CACHEDIR}/${f}.bcr" ] ; then
+            fn=( "${fn[@]}" "${BEECACHE_CACHEDIR}/${f}.bcr" )
+            continue
+        fi
+
+        echo >&2 "bee-cache: ${f}: Can't create inventory."
+        exit 1
+    done
+
+    TMPINSTALL=( "${fn[@]}" )
+    return 0
+}
+
+function usage() {
+    cat <<-EOF
+	bee-cache v${VERSION} 2012-2016
+	  by Marius Tolzmann <m@rius.berlin> and Tobias Dreyer <dreyer@molgen.mpg.de>
+
+	Usage: bee cache [options] <command> [<args>]
+
+	Options:
+	    -f, --fields        choose fields to print
+	    -i, --tmpinstall    install a package temporarily
+	    -h, --help          display this help
+
+	Commands:
+	    grep <pattern>
+	    rebuild
+	    update <pkgname...>
+	    print-uniq-files <pkgname>
+	    remove-uniq-files <pkgname>
+	    print-conflicting-files <pkgname>
+	    print-conflicts <pkgname>
+	    print-missing-files [pkgname]
+	    print-owners <file...>
+	    print-possible-owners <file...>
+	    print-matching-files <regex...>
+	    print-files <pkgname...>
+	    print-duplicates
+	    print-subtree-owners <path...>
+	    print-unowned-dirs <pkgname> <dir...>
+
+	EOF
+}
+
+options=$(${BEE_BINDIR}/beegetopt --name bee-cache \
+                 --option help/h \
+                 --option fields/f= \
+                 --option tmpinstall/i= \
+                 -- "$@")
+
+if [ $? != 0 ] ; then
+    usage
+    exit 1
+fi
+eval set -- "${options}"
+
+declare -a TMPINSTALL
+declare FIELDS="8-"
+
+while true ; do
+    case "$1" in
+        --help)
+            usage
+            exit 0
+            ;;
+        --tmpinstall)
+            TMPINSTALL=( "${tmpinstall[@]}" "$2" )
+            shift 2
+            ;;
+        --fields)
+            FIELDS=${2}
+            shift 2
+            ;;
+        --)
+            shift
+            break
+            ;;
+    esac
+done
+
+cmd=$1
+shift
+
+if [ "${cmd}" == "" ] ; then
+    usage
+    exit 0
+fi
+
+cache_verify
+tmpinstall_to_filenames
+
+case "${cmd}" in
+    grep)
+        cache_grep "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    rebuild)
+        cache_rebuild
+        ;;
+    update)
+        cache_update "${@}"
+        ;;
+    print-uniq-files)
+        print_uniq_files "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    remove-uniq-files)
+        remove_uniq_files "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-conflicting-files)
+        print_conflicting_files "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-conflicts)
+        print_conflicts "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-missing-files)
+        print_missing_files "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-owners)
+        cache_query owner "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-possible-owners)
+        cache_query candidates "${@}"
+        ;;
+    print-matching-files)
+        cache_query match "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-files)
+        cache_query files "${@}" | cut -d ' ' -f${FIELDS}
+        ;;
+    print-duplicates)
+        cache_query duplicates | cut -d ' ' -f${FIELDS}
+        ;;
+    print-subtree-owners)
+        cache_query subtree "${@}"
+        ;;
+    print-unowned-dirs)
+        cache_query unowned "${@}"
+        ;;
+    *)
+        echo >&2 "bee-cache: ${cmd}: Unknown command."
+        exit 1
+esac
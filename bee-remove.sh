@@ -0,0 +1,237 @@
+#!/bin/bash
+#
+# bee-remove - remove a installed bee-pkg
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+if [ -z "${BEE_VERSION}" ] ; then
+    echo >&2 "BEE-ERROR: please call $0 from bee .."
+    exit 1
+fi
+
+: ${BEE_BINDIR:=/usr/bin}
+: ${BEE_LIBEXECDIR:=/usr/libexec}
+
+function bee-cache() {
+    ${BEE_LIBEXECDIR}/bee/bee.d/bee-cache "${@}"
+}
+
+function bee-list() {
+    ${BEE_LIBEXECDIR}/bee/bee.d/bee-list "${@}"
+}
+
+function bee-query() {
+    ${BEE_LIBEXECDIR}/bee/bee.d/bee-query "${@}"
+}
+
+function pkg_remove_all() {
+    for pkg in "${@}" ; do
+        pkg_remove "${pkg}"
+    done
+}
+
+function pkg_remove() {
+    search=$1
+
+    # pattern is a pkg in BEE_METADIR
+    if [ -d "${BEE_METADIR}/${search}" ] ; then
+        do_remove ${search}
+        return
+    fi
+
+    # pattern is no installed pkg
+    # show all pkgs that match pattern
+    echo >&2 "bee-remove: FAILED to remove '${search}': No such package."
+    echo >&2 "bee-remove: List of installed packages matching '${search}':"
+    bee-list -i "${search}" | sed -e 's,^,    ,' >&2
+    if [ ${PIPESTATUS[0]} != 0 ] ; then
+        echo >&2 "    No packages found."
+    fi
+}
+
+
+# for each argument
+# recursive get all dirnames that are directories on same mountpoint
+#
+# /path/to/somewhere -> /path/to/somewhere /path/to /path
+#
+function subdirs() {
+    local last
+    local mtabexists=0
+
+    # checking for mountpoint boundaries only works if
+    # /etc/mtab exists since "stat" depends on it..
+    if [ -e "/etc/mtab" ] ; then
+        mtabexists=1
+    fi
+
+    for path in "${@}" ; do
+        last=""
+        while [ "${path:0:1}" = '/' -a "${path}" != "" ]  ; do
+            if [ ! -d "${path}" ] ; then
+                continue 2
+            fi
+
+            if [ "${mtabexists}" = "1" ] ; then
+                this=$(stat "${path}" --printf "%F%m")
+                if [ -n "${last}" -a "${last}" != "${this}" ] ; then
+                    continue 2
+                else
+                    last="${this}"
+                fi
+            fi
+
+            if [ "${this:0:9}" != 'directory' ] ; then
+                continue 2
+            fi
+
+            echo ${path}
+            path=${path%/*}
+        done
+    done
+}
+
+function do_remove() {
+    pkg=${1}
+
+    mv ${BEE_METADIR}/${pkg}/CONTENT{,.bee-remove} 2>/dev/null
+    if [ "$?" != "0" ] ; then
+        return 1
+    fi
+
+    echo "removing ${pkg} .."
+
+    bee-cache update ${pkg}
+    if [ $? -ne 0 ] ; then
+        echo >&2 "bee-remove: ${pkg}: bee-cache update failed."
+        exit 1
+    fi
+
+    run_hooks pre-remove ${pkg} ${BEE_METADIR}/${pkg}/CONTENT.bee-remove
+
+    # remove files that are uniq to the package..
+    if [ -n "${OPT_VERBOSE}" ] ; then
+        bee-cache --tmpinstall "${pkg}" remove-uniq-files "${pkg}" \
+            | sed -e "s,.*,removed '&',"
+    else
+        bee-cache --tmpinstall "${pkg}" remove-uniq-files "${pkg}" >/dev/null
+    fi
+
+    run_hooks post-remove ${pkg} ${BEE_METADIR}/${pkg}/CONTENT.bee-remove
+
+    if [ -r "${BEE_METADIR}/${pkg}/META" ] ; then
+        . "${BEE_METADIR}/${pkg}/META"
+    fi
+
+    # removing empty basedirs
+    if [ "${BEEMETAFORMAT}" = "2" ] ; then
+        vars=( PREFIX EPREFIX BINDIR SBINDIR LIBEXECDIR SYSCONFDIR \
+               SHAREDSTATEDIR LOCALSTATEDIR LIBDIR INCLUDEDIR \
+               DATAROOTDIR DATADIR INFODIR LOCALEDIR MANDIR DOCDIR )
+        dirs=( $(for var in ${vars[@]} ; do eval echo \${PKG_${var}} ; done) )
+        dirs=( $( subdirs ${dirs[@]} | sort -ur ) )
+
+        # dirs no other package owns (or anything below), asked at once
+        unowned=$(bee-cache print-unowned-dirs ${pkg} "${dirs[@]}")
+
+        for dir in "${dirs[@]}" ; do
+            # if dir does is not part of package -> skip it
+            content_file="${BEE_METADIR}/${pkg}/CONTENT.bee-remove"
+            if ! grep -q -l -E ":file=${dir}(/|$)" "${content_file}" ; then
+                continue
+            fi
+
+            # if dir is not empty -> skip it
+            nlinks=$( stat "${dir}" --printf "%h" )
+            if [ "${nlinks}" -gt 2 ] ; then
+                continue
+            fi
+
+            # dir is empty so let's check if it is still owned by some package
+            if grep -q -x -F -e "${dir}" <<< "${unowned}" ; then
+                rmdir ${OPT_VERBOSE:+-v} ${dir}
+            fi
+        done
+    fi
+
+    #cleanup meta directory
+    rm -fr ${OPT_VERBOSE:+-v} ${BEE_METADIR}/${pkg}
+    bee-cache update ${pkg}
+}
+
+function run_hooks() {
+    local action=${1}
+    local pkg=${2}
+    local content=${3}
+    : ${content:=${BEE_METADIR}/${pkg}/CONTENT}
+
+    for t in ${BEE_LIBEXECDIR}/bee/hooks.d/* ; do
+        ${t} ${action} ${pkg} ${content}
+    done
+}
+
+function usage() {
+    cat <<-EOF
+	bee-remove v${BEE_VERSION} 2009-2016
+	  by Marius Tolzmann <m@rius.berlin> and Tobias Dreyer <dreyer@molgen.mpg.de>
+
+	Usage: bee remove [options] <package>
+
+	Options:
+	    -h, --help        display this help
+	    -v, --verbose     print removed files and directories
+
+	EOF
+}
+
+options=$(${BEE_BINDIR}/beegetopt --name bee-remove \
+                 --option verbose/v \
+                 --option help/h \
+                 -- "$@")
+
+if [ $? != 0 ] ; then
+    usage
+    exit 1
+fi
+eval set -- "${options}"
+
+while true ; do
+    case "$1" in
+        --help)
+            usage
+            exit
+            ;;
+        --verbose)
+            OPT_VERBOSE="yes"
+            shift
+            ;;
+        --)
+            shift
+            if [ -z "${1}" ] ; then
+                usage
+                exit 1
+            fi
+            pkg_remove_all "$@"
+            break
+            ;;
+    esac
+done
@@ -0,0 +1,100 @@
+#!/bin/bash
+#
+# bench-bee-cache-inventory - time bee-cache-inventory on a generated CONTENT
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# usage: bench-bee-cache-inventory.sh [<lines> [<old bee-cache-inventory>]]
+#
+# prints the best of three runs of bee-cache-inventory on a CONTENT of
+# <lines> lines. an old bee-cache-inventory given as second argument is
+# timed as well and its output has to be identical.
+
+: ${BEE_BINDIR:=.}
+
+n=${1:-1000000}
+old=${2}
+
+TMPDIR=$(mktemp -d ${TMPDIR:-/tmp}/bench-bee-cache-inventory.XXXXXX) || exit 1
+trap "rm -rf ${TMPDIR}" EXIT
+
+# regular files, directories and symlinks spread over a few hundred
+# directories like the CONTENT of a big package
+function generate_content() {
+    awk -v n=${1} 'BEGIN {
+        srand(1)
+        for (i = 0; i < n; i++) {
+            path = sprintf("/usr/share/pkg%d/dir%d/sub%d/file%d", i % 97, i % 13, i % 7, i)
+            t = int(rand() * 10)
+            if (t == 0) {
+                printf "type=directory:mode=16877:access=drwxr-xr-x:uid=0(root):gid=0(root):size=4096:mtime=%d:nlink=2:md5=directory:file=%s\n", 1400000000 + i, path
+            } else if (t == 1) {
+                printf "type=symlink:mode=41471:access=lrwxrwxrwx:uid=0(root):gid=0(root):size=12:mtime=%d:nlink=1:md5=link:file=%s//../lib/target%d\n", 1400000000 + i, path, i
+            } else {
+                printf "type=regular:mode=33188:access=-rw-r--r--:uid=0(root):gid=0(root):size=%d:mtime=%d:nlink=1:md5=%08x%08x%08x%08x:file=%s\n", int(rand() * 100000), 1400000000 + i, i, i * 7, i * 13, i * 31, path
+            }
+        }
+    }'
+}
+
+# sets BEST to the best wall clock time of three runs of "${@}" in
+# milliseconds
+function best_of_three() {
+    local i start t
+
+    BEST=
+    for (( i = 0 ; i < 3 ; i++ )) ; do
+        start=${EPOCHREALTIME/./}
+        "${@}"
+        t=$(( (${EPOCHREALTIME/./} - start) / 1000 ))
+        if [ -z "${BEST}" ] || [ ${t} -lt ${BEST} ] ; then
+            BEST=${t}
+        fi
+    done
+}
+
+function report() {
+    local name=${1} t=${2}
+
+    printf "  %-28s %5d.%03ds\n" "${name}" $((t / 1000)) $((t % 1000))
+}
+
+function inventory() {
+    ${1} ${TMPDIR}/CONTENT >${TMPDIR}/out.${2}
+}
+
+generate_content ${n} >${TMPDIR}/CONTENT
+
+echo "${n} CONTENT lines ($(( $(stat -c %s ${TMPDIR}/CONTENT) >> 20 ))MB), best of 3"
+
+best_of_three inventory ${BEE_BINDIR}/bee-cache-inventory new
+report "bee-cache-inventory" ${BEST}
+
+if [ -n "${old}" ] ; then
+    best_of_three inventory ${old} old
+    report "old bee-cache-inventory" ${BEST}
+
+    if ! cmp -s ${TMPDIR}/out.old ${TMPDIR}/out.new ; then
+        echo >&2 "old and new bee-cache-inventory differ"
+        exit 1
+    fi
+fi
@@ -0,0 +1,128 @@
+#!/bin/bash
+#
+# bench-beesep - time beesep on generated CONTENT lines
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# usage: bench-beesep.sh [<lines> [<old beesep>]]
+#
+# runs beesep once per line, and with --server and --stream on 100 times
+# as many lines. an old beesep given as second argument is run per line
+# and with --server too and its output has to be identical.
+
+: ${BEE_BINDIR:=.}
+
+n=${1:-2000}
+old=${2}
+
+TMPDIR=$(mktemp -d ${TMPDIR:-/tmp}/bench-beesep.XXXXXX) || exit 1
+trap "rm -rf ${TMPDIR}" EXIT
+
+# regular files, directories and symlinks with blanks, quotes and
+# colons in their names
+function generate_content() {
+    awk -v n=${1} 'BEGIN {
+        srand(1)
+        for (i = 0; i < n; i++) {
+            path = sprintf("/usr/share/pkg%d/dir %d/file:%d", i % 97, i % 13, i)
+            if (i % 17 == 0)
+                path = path "'"'"'s"
+            t = int(rand() * 10)
+            if (t == 0) {
+                printf "type=directory:mode=16877:access=drwxr-xr-x:uid=0(root):gid=0(root):size=4096:mtime=%d:nlink=2:md5=directory:file=%s\n", 1400000000 + i, path
+            } else if (t == 1) {
+                printf "type=symlink:mode=41471:access=lrwxrwxrwx:uid=0(root):gid=0(root):size=12:mtime=%d:nlink=1:md5=link:file=%s//../lib/target%d\n", 1400000000 + i, path, i
+            } else {
+                printf "type=regular:mode=33188:access=-rw-r--r--:uid=0(root):gid=0(root):size=%d:mtime=%d:nlink=1:md5=%08x%08x%08x%08x:file=%s\n", int(rand() * 100000), 1400000000 + i, i, i * 7, i * 13, i * 31, path
+            }
+        }
+    }'
+}
+
+# sets ELAPSED to the wall clock time of "${@}" in milliseconds
+function elapsed() {
+    local start=${EPOCHREALTIME/./}
+
+    "${@}"
+
+    ELAPSED=$(( (${EPOCHREALTIME/./} - start) / 1000 ))
+}
+
+function report() {
+    local name=${1} t=${2}
+
+    printf "  %-28s %5d.%03ds\n" "${name}" $((t / 1000)) $((t % 1000))
+}
+
+function per_line() {
+    local beesep=${1} line
+
+    while IFS= read -r line ; do
+        ${beesep} "${line}"
+    done <${TMPDIR}/CONTENT >${TMPDIR}/out.${2} 2>&1
+}
+
+function server() {
+    local beesep=${1} i
+
+    for (( i = 0 ; i < 100 ; i++ )) ; do
+        cat ${TMPDIR}/requests
+    done | ${beesep} --server >${TMPDIR}/server.${2}
+}
+
+function stream() {
+    local i
+
+    for (( i = 0 ; i < 100 ; i++ )) ; do
+        echo ${TMPDIR}/CONTENT
+    done | xargs ${BEE_BINDIR}/beesep --stream >/dev/null
+}
+
+generate_content ${n} >${TMPDIR}/CONTENT
+sed -e 's/^/separate /' ${TMPDIR}/CONTENT >${TMPDIR}/requests
+
+echo "${n} CONTENT lines"
+
+elapsed per_line ${BEE_BINDIR}/beesep new
+report "beesep per line" ${ELAPSED}
+
+if [ -n "${old}" ] ; then
+    elapsed per_line ${old} old
+    report "old beesep per line" ${ELAPSED}
+fi
+
+elapsed server ${BEE_BINDIR}/beesep new
+report "beesep --server x100" ${ELAPSED}
+
+if [ -n "${old}" ] ; then
+    elapsed server ${old} old
+    report "old beesep --server x100" ${ELAPSED}
+
+    if ! cmp -s ${TMPDIR}/out.old ${TMPDIR}/out.new ||
+       ! cmp -s ${TMPDIR}/server.old ${TMPDIR}/server.new ; then
+        echo >&2 "old and new beesep differ"
+        exit 1
+    fi
+fi
+
+elapsed stream
+report "beesep --stream x100" ${ELAPSED}
@@ -0,0 +1,114 @@
+#!/bin/bash
+#
+# bench-coproc - time helper queries from bash: fork per query vs. coprocess
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# usage: bench-coproc.sh [<queries> [<bindir>]]
+#
+# bindir defaults to the build directory, beelib.config.sh is taken from
+# the current directory.
+
+: ${BEE_BINDIR:=${2:-.}}
+
+. ./beelib.config.sh
+
+n=${1:-1000}
+
+pkg=foo_dev-1.2.3_rc4-5.x86_64
+pkgs="foo-1.0-1 foo-1.10-1 foo-1.9_rc2-3 foo-1.2-12"
+line='type=file:mode=33188:uid=0:gid=0:size=1024:mtime=1400000000:md5=d41d8cd98f00b204e9800998ecf8427e:file=/usr/share/foo/bar baz'
+
+function bench_exec() {
+    local i
+
+    for (( i = 0 ; i < n ; i++ )) ; do
+        "${@}" >/dev/null
+    done
+}
+
+function bench_coproc() {
+    local i
+
+    for (( i = 0 ; i < n ; i++ )) ; do
+        bee_coproc_request "${@}"
+    done
+}
+
+function bench_beesep_exec() {
+    local i
+
+    for (( i = 0 ; i < n ; i++ )) ; do
+        eval $(${BEE_BINDIR}/beesep "${line}")
+    done
+}
+
+function bench_beesep_coproc() {
+    local i
+
+    for (( i = 0 ; i < n ; i++ )) ; do
+        bee_coproc_request BEESEP separate "${line}"
+        eval "${BEE_COPROC_REPLY[*]}"
+    done
+}
+
+# run "${@}" in the current shell, coprocesses are lost in subshells.
+# sets ELAPSED to the wall clock time in milliseconds.
+function elapsed() {
+    local start=${EPOCHREALTIME/./}
+
+    "${@}"
+
+    ELAPSED=$(( (${EPOCHREALTIME/./} - start) / 1000 ))
+}
+
+function report() {
+    local name=${1} t1=${2} t2=${3}
+
+    printf "  %-20s %5d.%03ds %5d.%03ds\n" "${name}" \
+        $((t1 / 1000)) $((t1 % 1000)) $((t2 / 1000)) $((t2 % 1000))
+}
+
+# bash warns about more than one coprocess at a time
+bee_coproc_start BEEVERSION ${BEE_BINDIR}/beeversion --server
+
+echo "${n} queries               exec      coproc"
+
+elapsed bench_exec ${BEE_BINDIR}/beeversion --format="%p %v" ${pkg}
+t1=${ELAPSED}
+elapsed bench_coproc BEEVERSION parse ${pkg} "%p %v"
+report "beeversion parse" ${t1} ${ELAPSED}
+
+elapsed bench_exec ${BEE_BINDIR}/beeversion --max ${pkgs}
+t1=${ELAPSED}
+elapsed bench_coproc BEEVERSION max ${pkgs}
+report "beeversion max" ${t1} ${ELAPSED}
+
+bee_coproc_stop BEEVERSION
+bee_coproc_start BEESEP ${BEE_BINDIR}/beesep --server
+
+elapsed bench_beesep_exec
+t1=${ELAPSED}
+elapsed bench_beesep_coproc
+report "beesep + eval" ${t1} ${ELAPSED}
+
+bee_coproc_stop BEESEP
@@ -0,0 +1,73 @@
+#
+# bee magic for autogen.sh
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+if [ ! -x ${S}/autogen.sh ] ; then
+    return
+fi
+
+BEE_BUILDTYPE_DETECTED=autogen
+
+#### bee_configure() ##########################################################
+
+bee_configure() {
+    start_cmd ${S}/autogen.sh ${DEFCONFIG} "$@"
+}
+
+#### bee_build() ##############################################################
+
+bee_build() {
+    start_cmd make ${BEE_MAKEFLAGS} "$@"
+}
+
+#### bee_install() ############################################################
+
+bee_install() {
+    start_cmd make ${BEE_MAKEFLAGS} install DESTDIR=${D} "$@"
+}
+
+
+# check IGNORE_DATAROOTDIR for compatibility with old bee-files
+if [ ${IGNORE_DATAROOTDIR} ] ; then
+    print_error "IGNORE_DATAROOTDIR is deprecated! please use BEE_CONFIGURE='compat' instead." >&2
+    BEE_CONFIGURE='compat'
+fi
+
+if [ "${BEE_CONFIGURE}" = "compat" ] ; then
+    unset DATAROOTDIR
+    unset LOCALEDIR
+    unset DOCDIR
+fi
+
+# create default configure options
+if [ -z "${DEFCONFIG}" ] ; then
+    for var in prefix bindir sbindir libexecdir sysconfdir \
+               sharedstatedir localstatedir libdir includedir \
+               datarootdir datadir infodir localedir mandir docdir ; do
+        DEFCONFIG="${DEFCONFIG} \${${var^^}:+--${var,,}=\${${var^^}}}"
+    done
+    DEFCONFIG="${DEFCONFIG} \${EPREFIX:+--exec-prefix=\${EPREFIX}}"
+fi
+
+# expand default configure options
+eval DEFCONFIG=\"${DEFCONFIG}\"
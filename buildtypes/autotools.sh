@@ -0,0 +1,96 @@
+#
+# bee magic for configure
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+#### detect autotools build type ##############################################
+
+if [ ! -x "${S}/configure" ] ; then
+    return
+fi
+
+
+if [ "${BEE_BUILDTYPE}" != "autotools" ] ; then
+    if ! egrep -qi "generated by.*autoconf" "${S}/configure" ; then
+        print_warning "GNU autotools detection failed."
+        print_warning "${S}/configure: does not seem to be generated by GNU autotools."
+        print_warning "use BEE_BUILDTYPE=autotools to force it anyway"
+        return
+    fi
+fi
+
+#### set autotools build type #################################################
+
+BEE_BUILDTYPE_DETECTED=autotools
+
+#### bee_configure() ##########################################################
+
+bee_configure() {
+    start_cmd ${S}/configure ${DEFCONFIG} "$@"
+}
+
+#### bee_build() ##############################################################
+
+bee_build() {
+    start_cmd make ${BEE_MAKEFLAGS} "$@"
+}
+
+#### bee_install() ############################################################
+
+bee_install() {
+    start_cmd make ${BEE_MAKEFLAGS} install DESTDIR=${D} "$@"
+}
+
+#### setup autotools build type ###############################################
+
+if ! grep -q datarootdir ${S}/configure ; then
+    print_info "[buildtype::autotools] Detected out-dated configure script. Switching to compat mode."
+    if [ "${BEE_CONFIGURE}" = "compat" ] ; then
+        print_warning "[buildtype::autotools] BEE_CONFIGURE=compat was auto-detected and may be removed from your bee-file."
+    fi
+    BEE_CONFIGURE='compat'
+fi
+
+# check IGNORE_DATAROOTDIR for compatibility with old bee-files
+if [ ${IGNORE_DATAROOTDIR} ] ; then
+    print_error "IGNORE_DATAROOTDIR is deprecated! please use BEE_CONFIGURE='compat' instead." >&2
+    BEE_CONFIGURE='compat'
+fi
+
+if [ "${BEE_CONFIGURE}" = "compat" ] ; then
+    unset DATAROOTDIR
+    unset LOCALEDIR
+    unset DOCDIR
+fi
+
+# create default configure options
+if [ -z "${DEFCONFIG}" ] ; then
+    for var in prefix bindir sbindir libexecdir sysconfdir \
+               sharedstatedir localstatedir libdir includedir \
+               datarootdir datadir infodir localedir mandir docdir ; do
+        DEFCONFIG="${DEFCONFIG} \${${var^^}:+--${var,,}=\${${var^^}}}"
+    done
+    DEFCONFIG="${DEFCONFIG} \${EPREFIX:+--exec-prefix=\${EPREFIX}}"
+fi
+
+# expand default configure options
+eval DEFCONFIG=\"${DEFCONFIG}\"
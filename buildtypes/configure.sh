@@ -0,0 +1,30 @@
+#
+# bee magic for configure
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+if [ "${BEE_BUILDTYPE}" = "configure" ] ; then
+     print_warning "BEE_BUILDTYPE=configure has been deprecated in favor of BEE_BUILDTYPE=autotools" >&2
+     BEE_BUILDTYPE=autotools
+     load_buildmagic autotools
+fi
@@ -0,0 +1,44 @@
+#
+#
+# bee magic for python modules
+#
+# Copyright (C) 2009-2016
+#       Marius Tolzmann <m@rius.berlin>
+#       Tobias Dreyer <dreyer@molgen.mpg.de>
+#       and other bee developers
+#
+# This file is part of bee.
+#
+# bee is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# this needs to be forced for now
+if [ ${BEE_BUILDTYPE} != "r-package" ] ; then
+    return
+fi
+
+BEE_BUILDTYPE_DETECTED="r-package"
+
+: ${R:=R}
+
+RHOME=$(${R} RHOME)
+
+RLIBRARY="${RHOME}/library"
+
+#### bee_install() ############################################################
+
+bee_install() {
+    start_cmd mkdir -p ${D}/${RLIBRARY}
+    start_cmd ${R} CMD INSTALL -l ${D}/${RLIBRARY} ${S}
+}
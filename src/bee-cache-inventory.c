@@ -27,15 +27,25 @@
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "bee_bloom.h"
 #include "bee_getopt.h"
+#include "bee_inventory.h"
+#include "bee_manifest.h"
+#include "bee_missing.h"
+#include "bee_output.h"
+#include "bee_paths.h"
+#include "bee_pool.h"
+#include "bee_sort.h"
 
 #define BCI_MAJOR    1
 #define BCI_MINOR    0
@@ -45,7 +55,25 @@
 #define ISFILE 1
 #define ISDIR  2
 
-#define BEE_STATIC_INLINE __attribute__((always_inline)) static inline
+#define SORT_BUFFER_DEFAULT (256 * 1024 * 1024)
+#define READ_BLOCK          (256 * 1024)
+
+#define OPT_SORTED 256
+#define OPT_MERGE  257
+#define OPT_INDEX  258
+#define OPT_CACHE  259
+#define OPT_CHECK  260
+#define OPT_TMPFILE 261
+#define OPT_TIMING  262
+#define OPT_CONFLICTS 263
+#define OPT_CONFLICTING_FILES 264
+#define OPT_UNIQUE 265
+#define OPT_UNLINK 266
+#define OPT_MISSING 267
+#define OPT_PACKAGE 268
+
+/* above this many changed packages rebuilding beats merging */
+#define CACHE_MERGE_MAX 256
 
 /* <pkg> <mtime> <uid> <gid> <mode> <size> <md5/md5 of symlink destination/type> <file without link destination> */
 struct item {
@@ -71,6 +99,48 @@ struct inventory_meta {
 
     int  multiplefiles;
     int  sync;
+    int  tmpfile;
+    int  timing;
+    long jobs;
+
+    int    sorted;
+    size_t sortbuffer;
+
+    int    merge;
+    char   **remove;
+    size_t nremove;
+
+    /* package and mode of bee_paths_open() */
+    char   *paths;
+    int    paths_mode;
+
+    /* files of missing_pkg or all packages that don't exist */
+    int    missing;
+    char   *missing_pkg;
+
+    int    index;
+
+    char   *cachedir;
+    int    check;
+};
+
+struct line_reader {
+    int    fd;
+    char   *buf;
+    size_t size;
+    size_t start;
+    size_t end;
+    int    eof;
+};
+
+/* the packages of a parallel inventory run */
+struct inventory_pool {
+    char *indname;
+    char *outdname;
+    struct inventory_meta meta;
+
+    char   **packages;
+    size_t npackages;
 };
 
 void print_version(void) {
@@ -83,6 +153,11 @@ void print_full_usage(void) {
 
     puts("Usage:");
     puts("    bee-cache-inventory [options] <file|directory>");
+    puts("    bee-cache-inventory --merge [-r <pkg>]... [-o <file>] <inventory> [<file>...]");
+    puts("    bee-cache-inventory --merge --conflicts|--conflicting-files <pkg> <inventory> [<file>...]");
+    puts("    bee-cache-inventory --merge --unique <pkg> [--unlink] <inventory> [<file>...]");
+    puts("    bee-cache-inventory --merge --missing [--package <pkg>] [-j <n>] <inventory> [<file>...]");
+    puts("    bee-cache-inventory --cache <dir> [--check] [--index] <metadir> [<pkg>...]");
     puts("");
     puts("Options:");
     puts("    -h | --help                      print this little help screen");
@@ -92,6 +167,40 @@ void print_full_usage(void) {
     puts("    -p | --prepend <text>            prepend <text> to each line of output");
     puts("    -a | --append <text>             append <text> to each line of output");
     puts("    -m | --multiplefiles             use -m to split output into multiple files");
+    puts("    -s | --sync                      make each output file durable before and its directory");
+    puts("                                     after it is renamed into place");
+    puts("         --tmpfile                   write outputs to an unnamed O_TMPFILE which is linked in");
+    puts("                                     once complete so a crash leaves no partial files behind");
+    puts("         --timing                    report the time spent flushing outputs on stderr");
+    puts("    -j | --jobs <n>                  inventory <n> packages concurrently (0: one per cpu)");
+    puts("                                     output is written in the same order as with -j 1");
+    puts("         --sorted                    sort output like 'LC_ALL=C sort -r -k8 -k1'");
+    puts("    -S | --buffer-size <size>        sort up to <size> bytes (suffix k, M, G) in memory");
+    puts("                                     per output file before spilling to $TMPDIR (default 256M)");
+    puts("");
+    puts("         --merge                     merge sorted <inventory> and <file>s in a single pass");
+    puts("                                     like 'sort -m -u -r -k8 -k1', -o may name <inventory> itself");
+    puts("    -r | --remove <pkg>              drop the lines of <pkg> from <inventory> while merging");
+    puts("         --index                     also write the binary index <file>.idx of the -o <file>");
+    puts("         --conflicts <pkg>           instead of the merged inventory print the lines of other");
+    puts("                                     packages whose size or md5 differ from a file of <pkg>");
+    puts("                                     of the same path, sorted by package and path");
+    puts("         --conflicting-files <pkg>   print the lines of <pkg> that conflict with other packages");
+    puts("         --unique <pkg>              print the lines of <pkg> whose path no other package has");
+    puts("         --unlink                    with --unique: remove these files and directories deepest");
+    puts("                                     first and print the lines of the removed ones");
+    puts("         --missing                   print the lines of files that don't exist, checked by");
+    puts("                                     -j <n> threads (keeps more lookups in flight on cold caches)");
+    puts("         --package <pkg>             with --missing: only check the files of <pkg>");
+    puts("");
+    puts("         --cache <dir>               bring <dir>/INVENTORY up to date with <metadir> by");
+    puts("                                     re-inventorying only packages whose CONTENT changed");
+    puts("                                     since the last run as recorded in <dir>/MANIFEST");
+    puts("                                     <pkg>s are always recreated as <dir>/<pkg>.bc");
+    puts("                                     recreated .bc files get a Bloom filter <dir>/<pkg>.bf");
+    puts("                                     of their paths");
+    puts("         --check                     with --cache: only print changed packages and exit");
+    puts("                                     with 1 if <dir>/INVENTORY is out of date");
 }
 
 void usage()
@@ -120,93 +229,195 @@ int init_inventory_meta(struct inventory_meta *meta)
     return 1;
 }
 
-short chomp(char *line)
+char *read_symlink(const char *filename)
 {
-    char *newline;
+    ssize_t ret;
+    char buffer[PATH_MAX + 1] = {0};
+    char *copy;
 
-    newline = strrchr(line, '\n');
-    assert(newline);
+    ret = readlink(filename, buffer, PATH_MAX);
 
-    if (!newline)
-        return 0;
+    if (ret == -1) {
+        fprintf(stderr, "bee-cache-inventory: warning: "
+                        "cannot restore empty symlink destination for file '%s': %m\n", filename);
+        return NULL;
+    }
 
-    *newline = '\0';
+    copy = strdup(buffer);
 
-    return 1;
+    if (!copy)
+        fprintf(stderr, "bee-cache-inventory: read_symlink: strdup: %m\n");
+
+    return copy;
 }
 
-int substitute(char *data, char from, char to)
+/*
+ * read a file in large blocks and hand out its lines in place: lines may
+ * be of any length, the buffer grows until the longest one fits
+ */
+static int reader_init(struct line_reader *r, int fd)
 {
-    char *c = NULL;
+    memset(r, 0, sizeof(*r));
 
-    c = data;
-    while((c = strchr(c, from)) != NULL) {
-        *(c++) = to;
+    r->fd   = fd;
+    r->size = READ_BLOCK;
+    r->buf  = malloc(r->size);
+    if (!r->buf) {
+        perror("malloc");
+        return 0;
     }
 
     return 1;
 }
 
-char *read_symlink(const char *filename)
+static void reader_free(struct line_reader *r)
 {
-    ssize_t ret;
-    char buffer[PATH_MAX + 1] = {0};
-    char *copy;
+    free(r->buf);
+    r->buf = NULL;
+}
 
-    ret = readlink(filename, buffer, PATH_MAX);
+static int reader_fill(struct line_reader *r)
+{
+    char *buf;
+    ssize_t n;
 
-    if (ret == -1) {
-        fprintf(stderr, "bee-cache-inventory: warning: "
-                        "cannot restore empty symlink destination for file '%s': %m\n", filename);
-        return NULL;
+    if (r->start) {
+        memmove(r->buf, r->buf + r->start, r->end - r->start);
+        r->end  -= r->start;
+        r->start = 0;
     }
 
-    copy = strdup(buffer);
+    if (r->end == r->size) {
+        buf = realloc(r->buf, r->size * 2);
+        if (!buf) {
+            perror("realloc");
+            return 0;
+        }
+        r->buf   = buf;
+        r->size *= 2;
+    }
 
-    if (!copy)
-        fprintf(stderr, "bee-cache-inventory: read_symlink: strdup: %m\n");
+    if (r->eof)
+        return 1;
 
-    return copy;
+    do {
+        n = read(r->fd, r->buf + r->end, r->size - r->end);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0)
+        return 0;
+
+    if (!n)
+        r->eof = 1;
+
+    r->end += n;
+
+    return 1;
 }
 
-BEE_STATIC_INLINE char *_extract_pattern(struct item *item, char **dest, char *hint, char *pattern, char size, int failok)
+/*
+ * RETURN:  1 .. *line is the next NUL terminated line without newline
+ *          0 .. end of file
+ *         -1 .. error
+ */
+static int reader_getline(struct line_reader *r, char **line)
 {
-    char *p;
+    char *nl;
+
+    while (1) {
+        nl = memchr(r->buf + r->start, '\n', r->end - r->start);
+        if (nl)
+            break;
 
-    p = strstr(hint, pattern);
-    if (!p)
-       p = strstr(item->data, pattern);
-    if (!p) {
-       if (failok)
-           return NULL;
-       fprintf(stderr, "syntax error while searching '%s' in '%s'\n", item->data, pattern);
-       item->data = NULL;
-       return NULL;
+        if (r->eof && r->start == r->end)
+            return 0;
+
+        /* last line without newline: reader_fill() made room for the NUL */
+        if (r->eof && r->end < r->size) {
+            nl = r->buf + r->end;
+            break;
+        }
+
+        if (!reader_fill(r))
+            return -1;
     }
-    p += size;
-    *dest = p;
-    return p;
+
+    *nl   = '\0';
+    *line = r->buf + r->start;
+
+    r->start = nl - r->buf + (nl < r->buf + r->end);
+
+    return 1;
 }
 
-#define EXTRACT_PATTERN(item, dest, hint, size, failok) \
-        ((hint) = _extract_pattern((item), &((item)->dest), (hint), #dest "=", (size)+1, (failok)))
+#define KEY_IS(key, len, name) ((len) == sizeof(name)-1 && !memcmp((key), (name), sizeof(name)-1))
+
+static char **item_field(struct item *item, char *key, size_t len)
+{
+    switch (*key) {
+        case 't':
+            return KEY_IS(key, len, "type")  ? &item->type  : NULL;
+        case 'm':
+            if (KEY_IS(key, len, "mode"))
+                return &item->mode;
+            if (KEY_IS(key, len, "mtime"))
+                return &item->mtime;
+            return KEY_IS(key, len, "md5")   ? &item->md5   : NULL;
+        case 'u':
+            return KEY_IS(key, len, "uid")   ? &item->uid   : NULL;
+        case 'g':
+            return KEY_IS(key, len, "gid")   ? &item->gid   : NULL;
+        case 's':
+            return KEY_IS(key, len, "size")  ? &item->size  : NULL;
+    }
+
+    return NULL;
+}
 
+/*
+ * split "key=value:key=value:...:file=<file>[//<dest>]" in a single pass:
+ * values end at the next ':' except for file which takes the rest of
+ * the line. unknown keys are skipped, the first of duplicate keys wins.
+ */
 int do_separation(char *line, struct item *item)
 {
-    char *p, *q;
+    char *p, *eq, *end;
+    char **dest;
 
     /* type,mode,access,uid,user,gid,group,size,mtime,nlink,md5,file(//dest) */
     item->data = line;
 
-    p = _extract_pattern(item, &(item->filename), item->data, ":file=", 6, 0);
-    if (!p)
-       return 0;
+    for (p = line; *p; p = end + 1) {
+        /* the file name may contain ':' and ends the line */
+        if (!strncmp(p, "file=", 5)) {
+            item->filename = p + 5;
+            break;
+        }
+
+        end = strchrnul(p, ':');
+        eq  = memchr(p, '=', end - p);
+
+        if (eq) {
+            dest = item_field(item, p, eq - p);
+            if (dest && !*dest)
+                *dest = eq + 1;
+        }
+
+        if (!*end)
+            break;
+
+        *end = '\0';
+    }
+
+    if (!item->filename || !item->type || !item->mode || !item->uid
+        || !item->gid || !item->size || !item->mtime)
+        return 0;
 
     /* get possible symlink destination */
-    q = strstr(item->filename, "//");
-    if (q) {
-        *q = '\0';
-        item->destination = q + 2;
+    p = strstr(item->filename, "//");
+    if (p) {
+        *p = '\0';
+        item->destination = p + 2;
 
         if (!*item->destination) {
             item->destination = read_symlink(item->filename);
@@ -218,25 +429,6 @@ int do_separation(char *line, struct item *item)
         }
     }
 
-    *(p-6) = 0;
-
-    p = item->data;
-    if (!EXTRACT_PATTERN(item, type, p, 4, 0))
-        return 0;
-    if (!EXTRACT_PATTERN(item, mode, p, 4, 0))
-        return 0;
-    if (!EXTRACT_PATTERN(item, uid, p, 3, 0))
-        return 0;
-    if (!EXTRACT_PATTERN(item, gid, p, 3, 0))
-        return 0;
-    if (!EXTRACT_PATTERN(item, size, p, 4, 0))
-        return 0;
-    if (!EXTRACT_PATTERN(item, mtime, p, 5, 0))
-        return 0;
-    EXTRACT_PATTERN(item, md5, p, 3, 1);
-
-    substitute(item->data, ':', '\0');
-
     return 1;
 }
 
@@ -246,69 +438,74 @@ int print_item(FILE *out, struct item item, struct inventory_meta meta)
     char *c;
 
     if(meta.prepend)
-        fputs(meta.prepend, out);
+        fputs_unlocked(meta.prepend, out);
 
     if(meta.package) {
-        fputs(meta.package, out);
-        fputc(' ', out);
+        fputs_unlocked(meta.package, out);
+        fputc_unlocked(' ', out);
     }
 
-    fputs(item.mtime, out);
+    fputs_unlocked(item.mtime, out);
 
-    fputc(' ', out);
-    fputs(item.uid, out);
+    fputc_unlocked(' ', out);
+    fputs_unlocked(item.uid, out);
 
-    fputc(' ', out);
-    fputs(item.gid, out);
+    fputc_unlocked(' ', out);
+    fputs_unlocked(item.gid, out);
 
-    fputc(' ', out);
-    fputs(item.mode, out);
+    fputc_unlocked(' ', out);
+    fputs_unlocked(item.mode, out);
 
-    fputc(' ', out);
+    fputc_unlocked(' ', out);
     if (strcmp(item.type, "directory") == 0) {
-        fputc('0', out);
+        fputc_unlocked('0', out);
     } else {
-        fputs(item.size, out);
+        fputs_unlocked(item.size, out);
     }
 
-    fputc(' ', out);
+    fputc_unlocked(' ', out);
     if(item.md5) {
-        fputs(item.md5, out);
+        fputs_unlocked(item.md5, out);
     } else if(strcmp(item.type, "symlink") == 0) {
         c = item.destination;
         while(*c != '\0') {
             if(*c == '%')
-                fputs("%25", out);
+                fputs_unlocked("%25", out);
             else if(*c == ' ')
-                fputs("%20", out);
+                fputs_unlocked("%20", out);
             else
-                fputc(*c, out);
+                fputc_unlocked(*c, out);
 
             c++;
         }
     } else {
-        fputs(item.type, out);
+        fputs_unlocked(item.type, out);
     }
 
-    fputc(' ', out);
-    fputs(item.filename, out);
+    fputc_unlocked(' ', out);
+    fputs_unlocked(item.filename, out);
 
     if(meta.append)
-        fputs(meta.append, out);
+        fputs_unlocked(meta.append, out);
 
-    fputc('\n', out);
+    fputc_unlocked('\n', out);
 
     return 1;
 }
 
-FILE *fopenf(char *mode, char *format, ...)
+static int output_flags(struct inventory_meta meta)
 {
-    FILE *fh;
+    return (meta.sync    ? BEE_OUTPUT_SYNC    : 0)
+         | (meta.tmpfile ? BEE_OUTPUT_TMPFILE : 0);
+}
+
+int openf(int flags, char *format, ...)
+{
+    int fd;
     int res;
     char *fname;
     va_list list;
 
-    assert(mode);
     assert(format);
 
     va_start(list, format);
@@ -316,14 +513,14 @@ FILE *fopenf(char *mode, char *format, ...)
     va_end(list);
     if (res < 0) {
         perror("vasprintf");
-        return NULL;
+        return -1;
     }
 
-    fh = fopen(fname, mode);
+    fd = open(fname, flags);
 
     free(fname);
 
-    return fh;
+    return fd;
 }
 
 int renamef(char *dest, char *source, ...)
@@ -354,20 +551,59 @@ int renamef(char *dest, char *source, ...)
     return 1;
 }
 
-int inventory_fhfh(FILE *infh, FILE *outfh, struct inventory_meta meta)
+int unlinkf(char *format, ...)
+{
+    int res;
+    char *fname;
+    va_list list;
+
+    assert(format);
+
+    va_start(list, format);
+    res = vasprintf(&fname, format, list);
+    va_end(list);
+    if (res < 0) {
+        perror("vasprintf");
+        return 0;
+    }
+
+    res = unlink(fname);
+
+    free(fname);
+
+    return !res;
+}
+
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+int inventory_fdfh(int infd, FILE *outfh, struct inventory_meta meta)
 {
-    char line[LINE_MAX];
+    struct line_reader reader;
     struct item item;
+    unsigned long lineno = 0;
+    char *line;
+    int res;
 
-    assert(infh);
+    assert(infd >= 0);
     assert(outfh);
 
-    while (fgets(line, LINE_MAX, infh) != NULL) {
-        chomp(line);
+    if (!reader_init(&reader, infd))
+        return 0;
+
+    /* print_item() writes unlocked */
+    flockfile(outfh);
+
+    while ((res = reader_getline(&reader, &line)) > 0) {
+        lineno++;
+
         init_item(&item);
         if (!do_separation(line, &item)) {
-            fprintf(stderr, "bee-cache-inventory: syntax error in '%s'\n", line);
-            return 0;
+            fprintf(stderr, "bee-cache-inventory: syntax error in line %lu\n", lineno);
+            res = -1;
+            break;
         }
 
         print_item(outfh, item, meta);
@@ -377,20 +613,25 @@ int inventory_fhfh(FILE *infh, FILE *outfh, struct inventory_meta meta)
             free(item.destination);
     }
 
-    return 1;
+    funlockfile(outfh);
+
+    reader_free(&reader);
+
+    return res == 0;
 }
 
 int inventory_filefile(char *infname, char *outfname, struct inventory_meta meta)
 {
     int res = 1;
-    FILE *infh;
+    int infd;
+    struct bee_output out;
     FILE *outfh;
-    pid_t pid;
+    FILE *fh;
 
     assert(infname);
 
-    infh = fopenf("r", "%s", infname);
-    if (!infh) {
+    infd = open(infname, O_RDONLY);
+    if (infd < 0) {
         if (errno == ENOENT || errno == ENOTDIR)
             return 1;
         fprintf(stderr, "failed to open file %s: %m\n", infname);
@@ -398,27 +639,34 @@ int inventory_filefile(char *infname, char *outfname, struct inventory_meta meta
     }
 
     if (outfname) {
-        pid = getpid();
-        outfh = fopenf("w", "%s.%d", outfname, pid);
+        outfh = bee_output_open(&out, outfname, output_flags(meta));
         if (!outfh) {
             fprintf(stderr, "failed to open file %s: %m\n", outfname);
-            fclose(infh);
+            close(infd);
             return 0;
         }
     } else {
         outfh = stdout;
     }
 
-    res = inventory_fhfh(infh, outfh, meta);
+    fh = outfh;
+    if (meta.sorted)
+        fh = bee_sort_open(outfh, meta.sortbuffer);
 
-    if (outfname) {
-        res = renamef(outfname, "%s.%d", outfname, pid);
-        if(!res)
-            perror("rename failed");
+    res = fh && inventory_fdfh(infd, fh, meta);
+
+    if (fh && fh != outfh && fclose(fh) == EOF)
+        res = 0;
+
+    if (outfname && res) {
+        res = bee_output_commit(&out);
+        if (!res)
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", outfname);
+    } else if (outfname) {
+        bee_output_abort(&out);
     }
 
-    fclose(infh);
-    fclose(outfh);
+    close(infd);
 
     return res;
 }
@@ -438,15 +686,148 @@ static void _strip_trailing(char *in, char c)
 
 }
 
+static void free_packages(char **packages, size_t npackages)
+{
+    size_t i;
+
+    for (i = 0; i < npackages; i++)
+        free(packages[i]);
+
+    free(packages);
+}
+
+/* collect the package directories in readdir order */
+static int read_packages(DIR *indh, char ***packages, size_t *npackages)
+{
+    struct dirent *indent;
+    char **p = NULL, **tmp;
+    size_t n = 0, size = 0;
+
+    while ((indent = readdir(indh))) {
+        if (*indent->d_name == '.')
+            continue;
+
+        if (n == size) {
+            size = size ? size * 2 : 64;
+            tmp  = realloc(p, size * sizeof(*p));
+            if (!tmp) {
+                perror("realloc");
+                free_packages(p, n);
+                return 0;
+            }
+            p = tmp;
+        }
+
+        p[n] = strdup(indent->d_name);
+        if (!p[n]) {
+            perror("strdup");
+            free_packages(p, n);
+            return 0;
+        }
+        n++;
+    }
+
+    *packages  = p;
+    *npackages = n;
+
+    return 1;
+}
+
+/* inventory package i of the pool to out or into <outdname>/<pkg>.inv */
+static int inventory_job(void *arg, size_t i, FILE *out)
+{
+    struct inventory_pool *pool = arg;
+    struct inventory_meta meta = pool->meta;
+    int res;
+    int infd;
+    char *infname;
+    char *outfname;
+
+    meta.package = pool->packages[i];
+
+    res = asprintf(&infname, "%s/%s/CONTENT", pool->indname, meta.package);
+    if (res < 0) {
+        perror("asprintf");
+        return 0;
+    }
+
+    if (pool->outdname) {
+        res = asprintf(&outfname, "%s/%s.inv", pool->outdname, meta.package);
+        if (res < 0) {
+            perror("asprintf");
+            free(infname);
+            return 0;
+        }
+
+        res = inventory_filefile(infname, outfname, meta);
+
+        free(infname);
+        free(outfname);
+
+        return res;
+    }
+
+    infd = open(infname, O_RDONLY);
+    if (infd < 0) {
+        res = (errno == ENOENT || errno == ENOTDIR);
+        if (!res)
+            fprintf(stderr, "failed to open file %s: %m\n", infname);
+        free(infname);
+        return res;
+    }
+
+    res = inventory_fdfh(infd, out, meta);
+    if (!res)
+        fprintf(stderr, "inventarization from %s failed: %m\n", infname);
+
+    close(infd);
+    free(infname);
+
+    return res;
+}
+
+/*
+ * inventory all packages in indh using meta.jobs threads
+ *
+ * with outdname each worker writes <outdname>/<pkg>.inv, otherwise the
+ * per package buffers are written to outfh in readdir order
+ */
+int inventory_parallel(DIR *indh, char *indname, char *outdname, FILE *outfh, struct inventory_meta meta)
+{
+    struct inventory_pool pool;
+    int res;
+
+    assert(indh);
+    assert(indname);
+    assert(outdname || outfh);
+
+    memset(&pool, 0, sizeof(pool));
+
+    pool.indname  = indname;
+    pool.outdname = outdname;
+    pool.meta     = meta;
+
+    if (!read_packages(indh, &pool.packages, &pool.npackages))
+        return 0;
+
+    res = bee_pool_run(pool.npackages, meta.jobs, inventory_job, &pool,
+                       outdname ? NULL : outfh);
+
+    free_packages(pool.packages, pool.npackages);
+
+    return res;
+}
+
 int inventory_dirfile(char *indname, char *outfname, struct inventory_meta meta)
 {
     int res = 1;
     DIR *indh;
     struct dirent *indent;
     char *dirname;
-    FILE *infh;
+    int infd;
+    struct bee_output out;
     FILE *outfh;
-    pid_t pid;
+    FILE *fh;
 
     assert(indname);
 
@@ -459,8 +840,7 @@ int inventory_dirfile(char *indname, char *outfname, struct inventory_meta meta)
     }
 
     if (outfname) {
-        pid = getpid();
-        outfh = fopenf("w", "%s.%d", outfname, pid);
+        outfh = bee_output_open(&out, outfname, output_flags(meta));
         if (!outfh) {
             fprintf(stderr, "failed to open file %s: %m\n", outfname);
             res = 0;
@@ -470,14 +850,31 @@ int inventory_dirfile(char *indname, char *outfname, struct inventory_meta meta)
         outfh = stdout;
     }
 
+    fh = outfh;
+    if (meta.sorted) {
+        fh = bee_sort_open(outfh, meta.sortbuffer);
+        if (!fh) {
+            res = 0;
+            fh = outfh;
+            goto closeoutfh;
+        }
+    }
+
+    if (meta.jobs > 1) {
+        res = inventory_parallel(indh, indname, NULL, fh, meta);
+        if (!res)
+            goto closeoutfh;
+        goto sorted;
+    }
+
     while ((indent = readdir(indh))) {
         dirname = indent->d_name;
 
         if (*dirname == '.')
             continue;
 
-        infh = fopenf("r", "%s/%s/CONTENT", indname, dirname);
-        if (!infh) {
+        infd = openf(O_RDONLY, "%s/%s/CONTENT", indname, dirname);
+        if (infd < 0) {
             if (errno == ENOENT || errno == ENOTDIR)
                 continue;
             fprintf(stderr, "failed to open file %s/%s/CONTENT: %m\n", indname, dirname);
@@ -487,26 +884,38 @@ int inventory_dirfile(char *indname, char *outfname, struct inventory_meta meta)
 
         meta.package = dirname;
 
-        res = inventory_fhfh(infh, outfh, meta);
+        res = inventory_fdfh(infd, fh, meta);
         if (!res) {
             fprintf(stderr, "inventarization from %s/%s/CONTENT to %s failed: %m\n",
                     indname, dirname, outfname ? outfname : "stdout");
-            fclose(infh);
+            close(infd);
             goto closeoutfh;
         }
 
-        fclose(infh);
+        close(infd);
+    }
+
+sorted:
+    if (fh != outfh) {
+        res = (fclose(fh) == 0);
+        fh  = outfh;
+        if (!res)
+            goto closeoutfh;
     }
 
     if (outfname) {
-        res = renamef(outfname, "%s.%d", outfname, pid);
-        if(!res)
-            perror("rename failed");
+        res = bee_output_commit(&out);
+        if (!res)
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", outfname);
+        goto closedir;
     }
 
 closeoutfh:
+    if (fh != outfh)
+        fclose(fh);
+
     if (outfname)
-        fclose(outfh);
+        bee_output_abort(&out);
 
 closedir:
     closedir(indh);
@@ -535,6 +944,12 @@ int inventory_dirdir(char *indname, char *outdname, struct inventory_meta meta)
         return 0;
     }
 
+    if (meta.jobs > 1) {
+        ret = inventory_parallel(indh, indname, outdname, NULL, meta);
+        closedir(indh);
+        return ret;
+    }
+
     while ((indent = readdir(indh))) {
         dirname = indent->d_name;
 
@@ -645,39 +1060,805 @@ int inventory(struct inventory_meta meta)
 }
 
 /*
- * RETURN:
- *     0 .. successful
- *     1 .. general error
+ * merge the sorted inventory argv[0] with the sorted files argv[1..] and
+ * drop the lines of meta.remove from argv[0]. the result replaces
+ * meta.outfile atomically or is written to stdout.
  */
-int main(int argc, char *argv[])
+int inventory_merge(int argc, char *argv[], struct inventory_meta meta)
 {
-    int opt = 0,
-        optindex = 0;
-    struct bee_getopt_ctl optctl;
-    struct bee_option options[] = {
-        BEE_OPTION_NO_ARG("help", 'h'),
-        BEE_OPTION_REQUIRED_ARG("prepend", 'p'),
-        BEE_OPTION_REQUIRED_ARG("append", 'a'),
-        BEE_OPTION_REQUIRED_ARG("output", 'o'),
-        BEE_OPTION_NO_ARG("multiple-files", 'm'),
-        BEE_OPTION_NO_ARG("sync", 's'),
-        BEE_OPTION_END
-    };
-    struct inventory_meta meta;
+    struct bee_sort_run *runs;
+    struct bee_output out;
+    FILE *outfh, *fh;
+    int i, res = 1;
 
-    if(argc < 2) {
-        usage();
-        return 1;
+    assert(argc > 0);
+
+    runs = calloc(argc, sizeof(*runs));
+    if (!runs) {
+        perror("calloc");
+        return 0;
     }
 
-    init_inventory_meta(&meta);
+    for (i = 0; i < argc; i++) {
+        runs[i].name = argv[i];
+        runs[i].fh   = fopen(argv[i], "r");
+        if (!runs[i].fh) {
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", argv[i]);
+            res = 0;
+            goto close;
+        }
+    }
 
-    bee_getopt_init(&optctl, argc-1, &argv[1], options);
+    qsort(meta.remove, meta.nremove, sizeof(*meta.remove), compare_strings);
 
-    optctl.program = "bee-cache-inventory";
+    runs[0].remove  = meta.remove;
+    runs[0].nremove = meta.nremove;
 
-    while((opt=bee_getopt(&optctl, &optindex)) != BEE_GETOPT_END) {
-        if (opt == BEE_GETOPT_ERROR) {
+    if (meta.outfile) {
+        outfh = bee_output_open(&out, meta.outfile, output_flags(meta));
+        if (!outfh) {
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", meta.outfile);
+            res = 0;
+            goto close;
+        }
+    } else {
+        outfh = stdout;
+    }
+
+    /* selections filter the merged inventory */
+    if (meta.paths)
+        fh = bee_paths_open(outfh, meta.paths, meta.paths_mode);
+    else if (meta.missing)
+        fh = bee_missing_open(outfh, meta.missing_pkg, meta.jobs);
+    else
+        fh = outfh;
+
+    if (!fh) {
+        res = 0;
+    } else {
+        res = bee_sort_merge(runs, argc, fh, 1);
+        if (fh != outfh && fclose(fh) == EOF)
+            res = 0;
+    }
+
+    if (!meta.outfile) {
+        if (fflush(outfh) == EOF) {
+            perror("bee-cache-inventory: stdout");
+            res = 0;
+        }
+    } else if (res) {
+        res = bee_output_commit(&out);
+        if (!res)
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", meta.outfile);
+    } else {
+        bee_output_abort(&out);
+    }
+
+close:
+    for (i = 0; i < argc; i++) {
+        if (runs[i].fh)
+            fclose(runs[i].fh);
+    }
+    free(runs);
+
+    return res;
+}
+
+/* write <outfile>.idx if requested */
+static int write_index(struct inventory_meta meta)
+{
+    char *index;
+    int res;
+
+    if (!meta.index)
+        return 1;
+
+    if (asprintf(&index, "%s.idx", meta.outfile) < 0) {
+        perror("asprintf");
+        return 0;
+    }
+
+    res = bee_inventory_index_write(meta.outfile, index, output_flags(meta));
+    if (!res)
+        fprintf(stderr, "bee-cache-inventory: %s: Indexing failed\n", meta.outfile);
+
+    free(index);
+
+    return res;
+}
+
+/* a package of <metadir> having a CONTENT file */
+struct cache_pkg {
+    char *name;
+    struct bee_manifest_stat content;
+    struct bee_manifest_entry *old;
+
+    int      changed;
+    int      forced;
+    int      created;
+    int      dirty;
+    uint64_t checksum;
+};
+
+struct inventory_cache {
+    char *cachedir;
+    char *metadir;
+    char *inventory;
+    char *manifest;
+
+    struct bee_manifest old;
+    int    valid;
+
+    struct cache_pkg *pkgs;
+    size_t npkgs;
+
+    /* manifest entries whose CONTENT is gone */
+    struct bee_manifest_entry **gone;
+    size_t ngone;
+};
+
+static int compare_cache_pkgs(const void *a, const void *b)
+{
+    const struct cache_pkg *x = a, *y = b;
+
+    return strcmp(x->name, y->name);
+}
+
+static struct cache_pkg *cache_find_pkg(struct inventory_cache *c, char *name)
+{
+    struct cache_pkg key;
+
+    key.name = name;
+
+    return bsearch(&key, c->pkgs, c->npkgs, sizeof(key), compare_cache_pkgs);
+}
+
+/* stat <metadir>/<pkg>/CONTENT of every package: O(packages) stat calls */
+static int cache_scan(struct inventory_cache *c)
+{
+    DIR *dh;
+    struct dirent *dent;
+    struct stat st;
+    struct cache_pkg *pkgs;
+    size_t alloc = 0;
+    char path[PATH_MAX];
+    int res = 1;
+
+    dh = opendir(c->metadir);
+    if (!dh) {
+        if (errno == ENOENT)
+            return 1;
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", c->metadir);
+        return 0;
+    }
+
+    while ((dent = readdir(dh))) {
+        if (*dent->d_name == '.')
+            continue;
+
+        if (snprintf(path, sizeof(path), "%s/CONTENT", dent->d_name) >= sizeof(path))
+            continue;
+
+        if (fstatat(dirfd(dh), path, &st, 0) < 0) {
+            if (errno == ENOENT || errno == ENOTDIR)
+                continue;
+            fprintf(stderr, "bee-cache-inventory: %s/%s: %m\n", c->metadir, path);
+            res = 0;
+            break;
+        }
+
+        if (c->npkgs == alloc) {
+            alloc = alloc ? alloc * 2 : 1024;
+            pkgs = realloc(c->pkgs, alloc * sizeof(*pkgs));
+            if (!pkgs) {
+                perror("realloc");
+                res = 0;
+                break;
+            }
+            c->pkgs = pkgs;
+        }
+
+        pkgs = &c->pkgs[c->npkgs];
+        memset(pkgs, 0, sizeof(*pkgs));
+
+        pkgs->name = strdup(dent->d_name);
+        if (!pkgs->name) {
+            perror("strdup");
+            res = 0;
+            break;
+        }
+
+        bee_manifest_stat(&pkgs->content, &st);
+        c->npkgs++;
+    }
+
+    closedir(dh);
+
+    qsort(c->pkgs, c->npkgs, sizeof(*c->pkgs), compare_cache_pkgs);
+
+    return res;
+}
+
+/* compare the scanned packages and the INVENTORY to the manifest */
+static int cache_compare(struct inventory_cache *c)
+{
+    struct bee_manifest_stat ms;
+    struct stat st;
+    struct cache_pkg *pkg;
+    size_t i;
+
+    c->valid = 0;
+
+    if (bee_manifest_read(&c->old, c->manifest)) {
+        if (stat(c->inventory, &st) == 0) {
+            bee_manifest_stat(&ms, &st);
+            c->valid = bee_manifest_stat_equal(&ms, &c->old.inventory);
+        }
+    } else if (errno == EINVAL) {
+        fprintf(stderr, "bee-cache-inventory: %s: Invalid manifest ignored.\n", c->manifest);
+    } else if (errno != ENOENT) {
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", c->manifest);
+        return 0;
+    }
+
+    for (i = 0; i < c->npkgs; i++) {
+        pkg = &c->pkgs[i];
+        pkg->old = bee_manifest_find(&c->old, pkg->name);
+        pkg->changed = !pkg->old || !bee_manifest_stat_equal(&pkg->content, &pkg->old->content);
+    }
+
+    c->gone = calloc(c->old.nentries ? c->old.nentries : 1, sizeof(*c->gone));
+    if (!c->gone) {
+        perror("calloc");
+        return 0;
+    }
+
+    for (i = 0; i < c->old.nentries; i++) {
+        if (!cache_find_pkg(c, c->old.entries[i].pkg))
+            c->gone[c->ngone++] = &c->old.entries[i];
+    }
+
+    return 1;
+}
+
+/* write the Bloom filter <bf> of the paths in the inventory file <bc> */
+static int cache_create_bf(char *bc, char *bf, struct inventory_meta meta)
+{
+    struct bee_bloom bloom;
+    FILE *fh;
+    char *line = NULL, *path;
+    size_t size = 0;
+    uint64_t nlines = 0;
+    ssize_t len;
+    int res = 0;
+
+    fh = fopen(bc, "r");
+    if (!fh) {
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", bc);
+        return 0;
+    }
+
+    while (getline(&line, &size, fh) > 0)
+        nlines++;
+
+    if (ferror(fh)) {
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", bc);
+        goto out;
+    }
+
+    if (!bee_bloom_init(&bloom, nlines)) {
+        perror("calloc");
+        goto out;
+    }
+
+    rewind(fh);
+
+    while ((len = getline(&line, &size, fh)) > 0) {
+        if (line[len-1] == '\n')
+            line[--len] = '\0';
+
+        /* the path like in the index: everything after the 7th space */
+        path = bee_sort_skip_fields(line, 7);
+        if (*path)
+            path++;
+
+        bee_bloom_add(&bloom, path, line + len - path);
+    }
+
+    if (ferror(fh)) {
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", bc);
+    } else {
+        res = bee_bloom_write(&bloom, bf, output_flags(meta));
+        if (!res)
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", bf);
+    }
+
+    bee_bloom_free(&bloom);
+
+out:
+    free(line);
+    fclose(fh);
+
+    return res;
+}
+
+/* recreate <cachedir>/<pkg>.bc with its Bloom filter <pkg>.bf and checksum it */
+static int cache_create_bc(struct inventory_cache *c, struct cache_pkg *pkg, struct inventory_meta meta)
+{
+    char *content;
+    char *bc, *bf;
+    int res;
+
+    if (asprintf(&content, "%s/%s/CONTENT", c->metadir, pkg->name) < 0) {
+        perror("asprintf");
+        return 0;
+    }
+
+    if (asprintf(&bc, "%s/%s.bc", c->cachedir, pkg->name) < 0) {
+        perror("asprintf");
+        free(content);
+        return 0;
+    }
+
+    if (asprintf(&bf, "%s/%s.bf", c->cachedir, pkg->name) < 0) {
+        perror("asprintf");
+        free(content);
+        free(bc);
+        return 0;
+    }
+
+    printf("creating %s ..\n", bc);
+
+    meta.package = pkg->name;
+    meta.sorted  = 1;
+
+    res = inventory_filefile(content, bc, meta);
+    if (res) {
+        res = bee_manifest_checksum(bc, &pkg->checksum);
+        if (!res)
+            fprintf(stderr, "bee-cache-inventory: %s: %m\n", bc);
+    }
+
+    if (res)
+        res = cache_create_bf(bc, bf, meta);
+
+    if (res) {
+        pkg->created = 1;
+        pkg->dirty   = !pkg->old || !pkg->old->has_checksum
+                       || pkg->old->checksum != pkg->checksum;
+    }
+
+    free(content);
+    free(bc);
+    free(bf);
+
+    return res;
+}
+
+/*
+ * cache files of a package without CONTENT: keep <pkg>.bc as <pkg>.bcr
+ * while the package is being removed and drop both once its metadir is
+ * gone. <pkg>.bf only exists next to <pkg>.bc.
+ */
+static int cache_drop_pkg(struct inventory_cache *c, char *name, struct inventory_meta meta)
+{
+    struct stat st;
+    char *dir, *bc, *bcr;
+    char *content;
+    int res = 1;
+
+    if (asprintf(&dir, "%s/%s", c->metadir, name) < 0) {
+        perror("asprintf");
+        return 0;
+    }
+
+    if (asprintf(&bc, "%s/%s.bc", c->cachedir, name) < 0) {
+        perror("asprintf");
+        free(dir);
+        return 0;
+    }
+
+    if (asprintf(&bcr, "%s/%s.bcr", c->cachedir, name) < 0) {
+        perror("asprintf");
+        free(dir);
+        free(bc);
+        return 0;
+    }
+
+    unlinkf("%s/%s.bf", c->cachedir, name);
+
+    if (stat(dir, &st) < 0 || !S_ISDIR(st.st_mode)) {
+        unlink(bc);
+        unlink(bcr);
+    } else if (access(bc, F_OK) == 0) {
+        printf("moving %s to %s..\n", bc, bcr);
+        res = renamef(bcr, "%s", bc);
+    } else if (access(bcr, F_OK) < 0) {
+        if (asprintf(&content, "%s/CONTENT.bee-remove", dir) < 0) {
+            perror("asprintf");
+            res = 0;
+        } else if (access(content, F_OK) == 0) {
+            printf("creating %s ..\n", bcr);
+            meta.package = name;
+            meta.sorted  = 1;
+            res = inventory_filefile(content, bcr, meta);
+            free(content);
+        } else {
+            free(content);
+        }
+    }
+
+    free(dir);
+    free(bc);
+    free(bcr);
+
+    return res;
+}
+
+/* merge the changed .bc files into the INVENTORY and drop removed packages */
+static int cache_merge(struct inventory_cache *c, char **argv, size_t argc, struct inventory_meta meta)
+{
+    char **remove;
+    size_t nremove = 0;
+    size_t i;
+    int res;
+
+    remove = calloc(c->npkgs + c->ngone + 1, sizeof(*remove));
+    if (!remove) {
+        perror("calloc");
+        return 0;
+    }
+
+    for (i = 0; i < c->npkgs; i++) {
+        if (c->pkgs[i].dirty)
+            remove[nremove++] = c->pkgs[i].name;
+    }
+
+    for (i = 0; i < c->ngone; i++) {
+        printf("removing %s from %s ..\n", c->gone[i]->pkg, c->inventory);
+        remove[nremove++] = c->gone[i]->pkg;
+    }
+
+    for (i = 1; i < argc; i++)
+        printf("merging %s with %s ..\n", argv[i], c->inventory);
+
+    meta.remove  = remove;
+    meta.nremove = nremove;
+    meta.outfile = c->inventory;
+
+    res = inventory_merge(argc, argv, meta);
+
+    free(remove);
+
+    return res;
+}
+
+static int cache_write_manifest(struct inventory_cache *c, struct inventory_meta meta)
+{
+    struct bee_manifest m;
+    struct bee_manifest_entry *e;
+    struct cache_pkg *pkg;
+    struct stat st;
+    size_t i;
+    int res;
+
+    if (stat(c->inventory, &st) < 0) {
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", c->inventory);
+        return 0;
+    }
+
+    bee_manifest_stat(&m.inventory, &st);
+
+    m.nentries = c->npkgs;
+    m.entries  = calloc(c->npkgs ? c->npkgs : 1, sizeof(*m.entries));
+    if (!m.entries) {
+        perror("calloc");
+        return 0;
+    }
+
+    for (i = 0; i < c->npkgs; i++) {
+        pkg = &c->pkgs[i];
+        e   = &m.entries[i];
+
+        e->pkg     = pkg->name;
+        e->content = pkg->content;
+
+        if (pkg->created) {
+            e->checksum     = pkg->checksum;
+            e->has_checksum = 1;
+        } else if (!pkg->changed && pkg->old->has_checksum) {
+            e->checksum     = pkg->old->checksum;
+            e->has_checksum = 1;
+        }
+    }
+
+    res = bee_manifest_write(&m, c->manifest, output_flags(meta));
+    if (!res)
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", c->manifest);
+
+    free(m.entries);
+
+    return res;
+}
+
+static void cache_free(struct inventory_cache *c)
+{
+    size_t i;
+
+    for (i = 0; i < c->npkgs; i++)
+        free(c->pkgs[i].name);
+
+    free(c->pkgs);
+    free(c->gone);
+    free(c->inventory);
+    free(c->manifest);
+
+    bee_manifest_free(&c->old);
+}
+
+/*
+ * bring <cachedir>/INVENTORY up to date with <metadir>: packages whose
+ * CONTENT did not change since <cachedir>/MANIFEST was written are not
+ * read at all. the packages in argv get a fresh <pkg>.bc in any case.
+ *
+ * RETURN: 1 if the inventory is (now) up to date, 0 otherwise
+ */
+int inventory_cache(char *metadir, int argc, char *argv[], struct inventory_meta meta)
+{
+    struct inventory_cache c;
+    struct cache_pkg *pkg;
+    char **merge = NULL;
+    size_t nmerge = 0;
+    size_t i;
+    int res = 0;
+
+    memset(&c, 0, sizeof(c));
+
+    _strip_trailing(metadir, '/');
+
+    c.cachedir = meta.cachedir;
+    c.metadir  = metadir;
+
+    if (asprintf(&c.inventory, "%s/INVENTORY", c.cachedir) < 0
+        || asprintf(&c.manifest, "%s/MANIFEST", c.cachedir) < 0) {
+        perror("asprintf");
+        goto out;
+    }
+
+    if (!cache_scan(&c) || !cache_compare(&c))
+        goto out;
+
+    if (meta.check) {
+        res = c.valid;
+
+        for (i = 0; i < c.npkgs; i++) {
+            if (c.pkgs[i].changed) {
+                puts(c.pkgs[i].name);
+                res = 0;
+            }
+        }
+
+        for (i = 0; i < c.ngone; i++) {
+            puts(c.gone[i]->pkg);
+            res = 0;
+        }
+
+        goto out;
+    }
+
+    if (mkdir(c.cachedir, 0777) < 0 && errno != EEXIST) {
+        fprintf(stderr, "bee-cache-inventory: %s: %m\n", c.cachedir);
+        goto out;
+    }
+
+    for (i = 0; i < (size_t)argc; i++) {
+        pkg = cache_find_pkg(&c, argv[i]);
+        if (pkg) {
+            pkg->forced = 1;
+            continue;
+        }
+        if (!cache_drop_pkg(&c, argv[i], meta))
+            goto out;
+    }
+
+    for (i = 0; i < c.ngone; i++) {
+        if (!cache_drop_pkg(&c, c.gone[i]->pkg, meta))
+            goto out;
+    }
+
+    merge = calloc(c.npkgs + 1, sizeof(*merge));
+    if (!merge) {
+        perror("calloc");
+        goto out;
+    }
+
+    merge[nmerge++] = c.inventory;
+
+    for (i = 0; c.valid && i < c.npkgs; i++) {
+        pkg = &c.pkgs[i];
+
+        if (!pkg->changed && !pkg->forced)
+            continue;
+
+        if (!cache_create_bc(&c, pkg, meta))
+            goto out;
+
+        if (!pkg->dirty)
+            continue;
+
+        if (asprintf(&merge[nmerge], "%s/%s.bc", c.cachedir, pkg->name) < 0) {
+            perror("asprintf");
+            goto out;
+        }
+
+        nmerge++;
+    }
+
+    if (nmerge > CACHE_MERGE_MAX)
+        c.valid = 0;
+
+    if (c.valid && nmerge == 1 && !c.ngone) {
+        for (i = 0; i < c.npkgs && !c.pkgs[i].changed; i++)
+            ;
+        /* no line changed: leave INVENTORY alone and only record new stats */
+        res = 1;
+        if (i < c.npkgs)
+            res = cache_write_manifest(&c, meta);
+        goto out;
+    }
+
+    if (c.valid && !cache_merge(&c, merge, nmerge, meta)) {
+        fprintf(stderr, "bee-cache-inventory: %s: Merging failed\n", c.inventory);
+        goto out;
+    }
+
+    if (!c.valid) {
+        /* .bc files of changed packages are stale: recreate them on demand */
+        for (i = 0; i < c.npkgs; i++) {
+            pkg = &c.pkgs[i];
+
+            if (pkg->forced && !pkg->created && !cache_create_bc(&c, pkg, meta))
+                goto out;
+
+            if (pkg->changed && !pkg->created) {
+                unlinkf("%s/%s.bc", c.cachedir, pkg->name);
+                unlinkf("%s/%s.bf", c.cachedir, pkg->name);
+            }
+        }
+
+        printf("creating %s ..\n", c.inventory);
+
+        meta.sorted  = 1;
+        meta.outfile = c.inventory;
+
+        if (!inventory_dirfile(metadir, c.inventory, meta)) {
+            fprintf(stderr, "bee-cache-inventory: %s: Creation failed\n", c.inventory);
+            goto out;
+        }
+    }
+
+    meta.outfile = c.inventory;
+
+    res = write_index(meta) && cache_write_manifest(&c, meta);
+
+out:
+    for (i = 1; i < nmerge; i++)
+        free(merge[i]);
+    free(merge);
+
+    cache_free(&c);
+
+    return res;
+}
+
+static void print_timing(struct inventory_meta meta)
+{
+    struct bee_output_stats st;
+
+    if (!meta.timing)
+        return;
+
+    bee_output_stats(&st);
+
+    fprintf(stderr, "bee-cache-inventory: flushed %llu files in %.3fs "
+                    "(write %.3fs, fdatasync %.3fs, rename %.3fs, directory fsync %.3fs)\n",
+            (unsigned long long)st.files,
+            (st.flush_ns + st.datasync_ns + st.rename_ns + st.dirsync_ns) / 1e9,
+            st.flush_ns / 1e9, st.datasync_ns / 1e9,
+            st.rename_ns / 1e9, st.dirsync_ns / 1e9);
+}
+
+/* parse <number>[kMG] */
+static int parse_size(char *arg, size_t *size)
+{
+    unsigned long long n;
+    char *end;
+    int shift = 0;
+
+    errno = 0;
+    n = strtoull(arg, &end, 10);
+    if (errno || end == arg || *arg == '-')
+        return 0;
+
+    if (*end) {
+        switch (*(end++)) {
+            case 'k': case 'K': shift = 10; break;
+            case 'm': case 'M': shift = 20; break;
+            case 'g': case 'G': shift = 30; break;
+            default:
+                return 0;
+        }
+    }
+
+    if (*end || !n || n > (SIZE_MAX >> shift))
+        return 0;
+
+    *size = n << shift;
+
+    return 1;
+}
+
+/*
+ * RETURN:
+ *     0 .. successful
+ *     1 .. general error
+ */
+int main(int argc, char *argv[])
+{
+    int opt = 0,
+        optindex = 0;
+    struct bee_getopt_ctl optctl;
+    struct bee_option options[] = {
+        BEE_OPTION_NO_ARG("help", 'h'),
+        BEE_OPTION_REQUIRED_ARG("prepend", 'p'),
+        BEE_OPTION_REQUIRED_ARG("append", 'a'),
+        BEE_OPTION_REQUIRED_ARG("output", 'o'),
+        BEE_OPTION_NO_ARG("multiple-files", 'm'),
+        BEE_OPTION_NO_ARG("sync", 's'),
+        BEE_OPTION_REQUIRED_ARG("jobs", 'j'),
+        BEE_OPTION(BEE_OPT_LONG("sorted"), BEE_OPT_VALUE(OPT_SORTED)),
+        BEE_OPTION_REQUIRED_ARG("buffer-size", 'S'),
+        BEE_OPTION(BEE_OPT_LONG("merge"), BEE_OPT_VALUE(OPT_MERGE)),
+        BEE_OPTION_REQUIRED_ARG("remove", 'r'),
+        BEE_OPTION(BEE_OPT_LONG("index"), BEE_OPT_VALUE(OPT_INDEX)),
+        BEE_OPTION(BEE_OPT_LONG("cache"), BEE_OPT_VALUE(OPT_CACHE),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION(BEE_OPT_LONG("check"), BEE_OPT_VALUE(OPT_CHECK)),
+        BEE_OPTION(BEE_OPT_LONG("tmpfile"), BEE_OPT_VALUE(OPT_TMPFILE)),
+        BEE_OPTION(BEE_OPT_LONG("timing"), BEE_OPT_VALUE(OPT_TIMING)),
+        BEE_OPTION(BEE_OPT_LONG("conflicts"), BEE_OPT_VALUE(OPT_CONFLICTS),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION(BEE_OPT_LONG("conflicting-files"), BEE_OPT_VALUE(OPT_CONFLICTING_FILES),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION(BEE_OPT_LONG("unique"), BEE_OPT_VALUE(OPT_UNIQUE),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION(BEE_OPT_LONG("unlink"), BEE_OPT_VALUE(OPT_UNLINK)),
+        BEE_OPTION(BEE_OPT_LONG("missing"), BEE_OPT_VALUE(OPT_MISSING)),
+        BEE_OPTION(BEE_OPT_LONG("package"), BEE_OPT_VALUE(OPT_PACKAGE),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION_END
+    };
+    struct inventory_meta meta;
+    char *end;
+    char **remove;
+    int unlink_files = 0;
+
+    if(argc < 2) {
+        usage();
+        return 1;
+    }
+
+    init_inventory_meta(&meta);
+
+    meta.jobs = 1;
+    meta.sortbuffer = SORT_BUFFER_DEFAULT;
+
+    bee_getopt_init(&optctl, argc-1, &argv[1], options);
+
+    optctl.program = "bee-cache-inventory";
+
+    while((opt=bee_getopt(&optctl, &optindex)) != BEE_GETOPT_END) {
+        if (opt == BEE_GETOPT_ERROR) {
             return 1;
         }
 
@@ -710,18 +1891,178 @@ int main(int argc, char *argv[])
             case 's':
                 meta.sync = 1;
                 break;
+
+            case 'j':
+                errno = 0;
+                meta.jobs = strtol(optctl.optarg, &end, 10);
+                if (errno || *end || end == optctl.optarg || meta.jobs < 0) {
+                    fprintf(stderr, "bee-cache-inventory: %s: Invalid number of jobs.\n", optctl.optarg);
+                    return 1;
+                }
+                if (!meta.jobs)
+                    meta.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+                break;
+
+            case OPT_SORTED:
+                meta.sorted = 1;
+                break;
+
+            case 'S':
+                if (!parse_size(optctl.optarg, &meta.sortbuffer)) {
+                    fprintf(stderr, "bee-cache-inventory: %s: Invalid buffer size.\n", optctl.optarg);
+                    return 1;
+                }
+                break;
+
+            case OPT_MERGE:
+                meta.merge = 1;
+                break;
+
+            case OPT_INDEX:
+                meta.index = 1;
+                break;
+
+            case OPT_CACHE:
+                meta.cachedir = optctl.optarg;
+                break;
+
+            case OPT_CHECK:
+                meta.check = 1;
+                break;
+
+            case OPT_TMPFILE:
+                meta.tmpfile = 1;
+                break;
+
+            case OPT_TIMING:
+                meta.timing = 1;
+                break;
+
+            case OPT_CONFLICTS:
+                meta.paths = optctl.optarg;
+                meta.paths_mode = BEE_PATHS_CONFLICTS;
+                break;
+
+            case OPT_CONFLICTING_FILES:
+                meta.paths = optctl.optarg;
+                meta.paths_mode = BEE_PATHS_CONFLICTING_FILES;
+                break;
+
+            case OPT_UNIQUE:
+                meta.paths = optctl.optarg;
+                meta.paths_mode = BEE_PATHS_UNIQUE;
+                break;
+
+            case OPT_UNLINK:
+                unlink_files = 1;
+                break;
+
+            case OPT_MISSING:
+                meta.missing = 1;
+                break;
+
+            case OPT_PACKAGE:
+                if (*optctl.optarg)
+                    meta.missing_pkg = optctl.optarg;
+                break;
+
+            case 'r':
+                remove = realloc(meta.remove, (meta.nremove + 1) * sizeof(*remove));
+                if (!remove) {
+                    perror("realloc");
+                    return 1;
+                }
+                meta.remove = remove;
+                meta.remove[meta.nremove++] = optctl.optarg;
+                break;
         }
     }
 
+    if (meta.missing_pkg && !meta.missing) {
+        fputs("cannot accept option --package without option --missing\n", stderr);
+        usage();
+        return 1;
+    }
+
+    if (unlink_files) {
+        if (!meta.paths || meta.paths_mode != BEE_PATHS_UNIQUE) {
+            fputs("cannot accept option --unlink without option --unique <pkg>\n", stderr);
+            usage();
+            return 1;
+        }
+        meta.paths_mode = BEE_PATHS_UNLINK;
+    }
+
     if(meta.multiplefiles && meta.outfile == NULL) {
         fputs("cannot accept option -m without option -o <dir>\n", stderr);
         usage();
         return 1;
     }
 
+    if (meta.cachedir) {
+        argv = &optctl.argv[optctl.optind];
+        argc = optctl.argc-optctl.optind;
+
+        if (argc < 1 || meta.outfile || meta.merge || meta.nremove || meta.multiplefiles) {
+            usage();
+            return 1;
+        }
+
+        if (!inventory_cache(argv[0], argc-1, &argv[1], meta))
+            return 1;
+
+        print_timing(meta);
+
+        return 0;
+    }
+
+    if (meta.check) {
+        fputs("cannot accept option --check without option --cache <dir>\n", stderr);
+        usage();
+        return 1;
+    }
+
+    if(meta.index && (meta.outfile == NULL || meta.multiplefiles)) {
+        fputs("cannot accept option --index without option -o <file>\n", stderr);
+        usage();
+        return 1;
+    }
+
     argv = &optctl.argv[optctl.optind];
     argc = optctl.argc-optctl.optind;
 
+    if (meta.merge) {
+        if (argc < 1 || meta.multiplefiles || ((meta.paths || meta.missing) && meta.index)
+            || (meta.paths && meta.missing)) {
+            usage();
+            return 1;
+        }
+
+        if (!inventory_merge(argc, argv, meta)) {
+            fprintf(stderr, "bee-cache-inventory: %s: Merging failed\n", argv[0]);
+            return 1;
+        }
+
+        if (!write_index(meta))
+            return 1;
+
+        print_timing(meta);
+
+        return 0;
+    }
+
+    if (meta.paths || meta.missing) {
+        fputs("cannot accept option --conflicts, --conflicting-files, --unique or --missing without option --merge\n", stderr);
+        usage();
+        return 1;
+    }
+
+    if (meta.nremove) {
+        fputs("cannot accept option -r without option --merge\n", stderr);
+        usage();
+        return 1;
+    }
+
     if(argc != 1) {
         usage();
         return 1;
@@ -734,8 +2075,10 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    if (meta.sync)
-        sync();
+    if (!write_index(meta))
+        return 1;
+
+    print_timing(meta);
 
     return 0;
 }
@@ -0,0 +1,438 @@
+/*
+** bee-cache-query - answer queries from the binary inventory index
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "bee_bloom.h"
+#include "bee_getopt.h"
+#include "bee_inventory.h"
+
+#define BCQ_MAJOR    1
+#define BCQ_MINOR    0
+#define BCQ_PATCHLVL 0
+
+/* exit codes like grep(1) */
+#define BCQ_FOUND    0
+#define BCQ_NOTFOUND 1
+#define BCQ_ERROR    2
+
+void print_version(void)
+{
+    printf("bee-cache-query v%d.%d.%d - "
+           "by Marius Tolzmann <m@rius.berlin> 2016\n",
+           BCQ_MAJOR, BCQ_MINOR, BCQ_PATCHLVL);
+}
+
+void print_full_usage(void)
+{
+    puts("Usage:");
+    puts("    bee-cache-query [options] <command> [<args>]");
+    puts("");
+    puts("Options:");
+    puts("    -h | --help                      print this little help screen");
+    puts("    -i | --inventory <file>          query <file>.idx of inventory <file>");
+    puts("    -u | --update                    (re)build the index if it is missing or stale");
+    puts("");
+    puts("Commands:");
+    puts("    index                            (re)build the index, with -u only if it is missing");
+    puts("                                     or stale");
+    puts("    owner <path>...                  print the inventory lines of <path>");
+    puts("    files <pkg>...                   print the inventory lines of <pkg>");
+    puts("    duplicates                       print the inventory lines of paths owned");
+    puts("                                     more than once like 'uniq -D -f7'");
+    puts("    subtree <path>...                print the packages owning <path> or anything below");
+    puts("    unowned <pkg> <dir>...           print each <dir> that no package but <pkg> owns");
+    puts("                                     (nor anything below it)");
+    puts("    search <string>...               print the inventory lines of paths containing");
+    puts("                                     <string> grouped by package");
+    puts("    match <regex>...                 print the inventory lines of paths matching the");
+    puts("                                     extended <regex> grouped by package");
+    puts("    candidates <path>...             print '<pkg> <path>' for each package that may own");
+    puts("                                     <path>: packages whose Bloom filter <pkg>.bf next");
+    puts("                                     to the inventory rejects <path> are skipped");
+}
+
+void usage(void)
+{
+    print_version();
+    print_full_usage();
+}
+
+static void print_lines(struct bee_inventory *inv, uint32_t *recs, uint32_t first, uint32_t count)
+{
+    uint32_t i;
+
+    struct bee_inventory_record *rec;
+
+    for (i = first; i < first + count; i++) {
+        rec = &inv->records[recs ? recs[i] : i];
+        fwrite(BEE_INVENTORY_TEXT(inv, rec->line), rec->length, 1, stdout);
+        putchar('\n');
+    }
+}
+
+static int query_owner(struct bee_inventory *inv, int argc, char *argv[])
+{
+    struct bee_inventory_path *path;
+    int i, res = BCQ_NOTFOUND;
+
+    for (i = 0; i < argc; i++) {
+        path = bee_inventory_find_path(inv, argv[i]);
+        if (!path)
+            continue;
+
+        print_lines(inv, inv->owners, path->first, path->count);
+        res = BCQ_FOUND;
+    }
+
+    return res;
+}
+
+static int query_files(struct bee_inventory *inv, int argc, char *argv[])
+{
+    struct bee_inventory_pkg *pkg;
+    int i, res = BCQ_NOTFOUND;
+
+    for (i = 0; i < argc; i++) {
+        pkg = bee_inventory_find_pkg(inv, argv[i]);
+        if (!pkg)
+            continue;
+
+        print_lines(inv, NULL, pkg->first, pkg->count);
+        res = BCQ_FOUND;
+    }
+
+    return res;
+}
+
+/* walk the path table backwards to print in inventory order */
+static int query_duplicates(struct bee_inventory *inv)
+{
+    struct bee_inventory_path *path;
+    uint64_t i;
+    int res = BCQ_NOTFOUND;
+
+    for (i = inv->header->npaths; i-- > 0; ) {
+        path = &inv->paths[i];
+        if (path->count < 2)
+            continue;
+
+        print_lines(inv, inv->owners, path->first, path->count);
+        res = BCQ_FOUND;
+    }
+
+    return res;
+}
+
+static int query_subtree(struct bee_inventory *inv, int argc, char *argv[])
+{
+    struct bee_inventory_node *node;
+    uint32_t *pkgs;
+    size_t npkgs, i;
+    char *seen;
+    int a, res = BCQ_NOTFOUND;
+
+    seen = calloc(inv->header->npkgs ? inv->header->npkgs : 1, 1);
+    if (!seen) {
+        perror("calloc");
+        return BCQ_ERROR;
+    }
+
+    for (a = 0; a < argc; a++) {
+        node = bee_inventory_find_node(inv, argv[a]);
+        if (!node)
+            continue;
+
+        if (!bee_inventory_subtree_pkgs(inv, node, &pkgs, &npkgs)) {
+            res = BCQ_ERROR;
+            break;
+        }
+
+        for (i = 0; i < npkgs; i++)
+            seen[pkgs[i]] = 1;
+
+        free(pkgs);
+    }
+
+    /* in package table order, each package once */
+    for (i = 0; res != BCQ_ERROR && i < inv->header->npkgs; i++) {
+        if (!seen[i])
+            continue;
+
+        puts(BEE_INVENTORY_STRING(inv, inv->pkgs[i].name));
+        res = BCQ_FOUND;
+    }
+
+    free(seen);
+
+    return res;
+}
+
+static int query_unowned(struct bee_inventory *inv, int argc, char *argv[])
+{
+    int i, res = BCQ_NOTFOUND;
+
+    for (i = 1; i < argc; i++) {
+        if (bee_inventory_owned_by_other(inv, argv[i], argv[0]))
+            continue;
+
+        puts(argv[i]);
+        res = BCQ_FOUND;
+    }
+
+    return res;
+}
+
+static int query_match(struct bee_inventory *inv, int argc, char *argv[], int flags)
+{
+    struct bee_inventory_path *path;
+    uint32_t *paths;
+    size_t npaths, i;
+    uint64_t r;
+    char *seen;
+    int a, res = BCQ_NOTFOUND;
+
+    seen = calloc(inv->header->nrecords ? inv->header->nrecords : 1, 1);
+    if (!seen) {
+        perror("calloc");
+        return BCQ_ERROR;
+    }
+
+    for (a = 0; a < argc; a++) {
+        if (!bee_inventory_match_paths(inv, argv[a], flags, &paths, &npaths)) {
+            res = BCQ_ERROR;
+            break;
+        }
+
+        for (i = 0; i < npaths; i++) {
+            path = &inv->paths[paths[i]];
+            for (r = path->first; r < path->first + path->count; r++)
+                seen[inv->owners[r]] = 1;
+        }
+
+        free(paths);
+    }
+
+    /* records are grouped by package, each line once */
+    for (r = 0; res != BCQ_ERROR && r < inv->header->nrecords; r++) {
+        if (!seen[r])
+            continue;
+
+        print_lines(inv, NULL, r, 1);
+        res = BCQ_FOUND;
+    }
+
+    free(seen);
+
+    return res;
+}
+
+/*
+ * ask the filter <dir of inventory>/<pkg>.bf of every package instead of
+ * reading its lines. a package without a usable filter can't be skipped.
+ */
+static int query_candidates(struct bee_inventory *inv, char *inventory, int argc, char *argv[])
+{
+    struct bee_bloom bloom;
+    char *dir, *slash, *bf, *pkg;
+    size_t *lens;
+    uint64_t i;
+    int a, have, res = BCQ_NOTFOUND;
+
+    slash = strrchr(inventory, '/');
+    dir   = slash ? strndup(inventory, slash - inventory + 1) : strdup("");
+    lens  = calloc(argc, sizeof(*lens));
+    if (!dir || !lens) {
+        perror("calloc");
+        free(dir);
+        free(lens);
+        return BCQ_ERROR;
+    }
+
+    for (a = 0; a < argc; a++)
+        lens[a] = strlen(argv[a]);
+
+    for (i = 0; i < inv->header->npkgs; i++) {
+        pkg = BEE_INVENTORY_STRING(inv, inv->pkgs[i].name);
+
+        if (asprintf(&bf, "%s%s.bf", dir, pkg) < 0) {
+            perror("asprintf");
+            res = BCQ_ERROR;
+            break;
+        }
+
+        have = bee_bloom_open(&bloom, bf);
+        free(bf);
+
+        for (a = 0; a < argc; a++) {
+            if (have && !bee_bloom_test(&bloom, argv[a], lens[a]))
+                continue;
+
+            printf("%s %s\n", pkg, argv[a]);
+            res = BCQ_FOUND;
+        }
+
+        if (have)
+            bee_bloom_free(&bloom);
+    }
+
+    free(lens);
+    free(dir);
+
+    return res;
+}
+
+/*
+ * RETURN:
+ *     0 .. something was found
+ *     1 .. nothing was found
+ *     2 .. error
+ */
+int main(int argc, char *argv[])
+{
+    int opt = 0,
+        optindex = 0;
+    struct bee_getopt_ctl optctl;
+    struct bee_option options[] = {
+        BEE_OPTION_NO_ARG("help", 'h'),
+        BEE_OPTION_REQUIRED_ARG("inventory", 'i'),
+        BEE_OPTION_NO_ARG("update", 'u'),
+        BEE_OPTION_END
+    };
+    struct bee_inventory inv;
+    char *inventory = NULL;
+    char *index;
+    char *cmd;
+    int update = 0;
+    int res;
+
+    bee_getopt_init(&optctl, argc-1, &argv[1], options);
+
+    optctl.program = "bee-cache-query";
+
+    while((opt=bee_getopt(&optctl, &optindex)) != BEE_GETOPT_END) {
+        if (opt == BEE_GETOPT_ERROR)
+            return BCQ_ERROR;
+
+        switch(opt) {
+            case 'h':
+                usage();
+                return BCQ_FOUND;
+
+            case 'i':
+                inventory = optctl.optarg;
+                break;
+
+            case 'u':
+                update = 1;
+                break;
+        }
+    }
+
+    argv = &optctl.argv[optctl.optind];
+    argc = optctl.argc-optctl.optind;
+
+    if (!inventory || argc < 1) {
+        usage();
+        return BCQ_ERROR;
+    }
+
+    cmd = argv[0];
+    argv++;
+    argc--;
+
+    if (asprintf(&index, "%s.idx", inventory) < 0) {
+        perror("asprintf");
+        return BCQ_ERROR;
+    }
+
+    if (!strcmp(cmd, "index")) {
+        res = 0;
+        if (update) {
+            res = bee_inventory_open(&inv, inventory, index);
+            if (res)
+                bee_inventory_close(&inv);
+        }
+        if (!res)
+            res = bee_inventory_index_write(inventory, index, 0);
+        free(index);
+        return res ? BCQ_FOUND : BCQ_ERROR;
+    }
+
+    res = bee_inventory_open(&inv, inventory, index);
+
+    if (!res && update && (errno == ESTALE || errno == ENOENT)) {
+        if (!bee_inventory_index_write(inventory, index, 0)) {
+            free(index);
+            return BCQ_ERROR;
+        }
+        res = bee_inventory_open(&inv, inventory, index);
+    }
+
+    if (!res) {
+        if (errno == ESTALE)
+            fprintf(stderr, "bee-cache-query: %s: Index is out of date.\n", index);
+        else
+            fprintf(stderr, "bee-cache-query: %s: %m\n", index);
+        free(index);
+        return BCQ_ERROR;
+    }
+
+    free(index);
+
+    if (!strcmp(cmd, "owner") && argc) {
+        res = query_owner(&inv, argc, argv);
+    } else if (!strcmp(cmd, "files") && argc) {
+        res = query_files(&inv, argc, argv);
+    } else if (!strcmp(cmd, "duplicates") && !argc) {
+        res = query_duplicates(&inv);
+    } else if (!strcmp(cmd, "subtree") && argc) {
+        res = query_subtree(&inv, argc, argv);
+    } else if (!strcmp(cmd, "unowned") && argc > 1) {
+        res = query_unowned(&inv, argc, argv);
+    } else if (!strcmp(cmd, "search") && argc) {
+        res = query_match(&inv, argc, argv, BEE_INVENTORY_MATCH_STRING);
+    } else if (!strcmp(cmd, "match") && argc) {
+        res = query_match(&inv, argc, argv, BEE_INVENTORY_MATCH_REGEX);
+    } else if (!strcmp(cmd, "candidates") && argc) {
+        res = query_candidates(&inv, inventory, argc, argv);
+    } else {
+        fprintf(stderr, "bee-cache-query: %s: Unknown command or wrong number of arguments.\n", cmd);
+        res = BCQ_ERROR;
+    }
+
+    bee_inventory_close(&inv);
+
+    if (fflush(stdout) == EOF) {
+        perror("bee-cache-query: stdout");
+        return BCQ_ERROR;
+    }
+
+    return res;
+}
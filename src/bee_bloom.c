@@ -0,0 +1,234 @@
+/*
+** bee_bloom - Bloom filters of the paths of a package
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bee_bloom.h"
+#include "bee_output.h"
+
+/* murmur3 finalizer */
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+/* FNV-1a mixed so that both halves of the double hashing are usable */
+static void hash_key(const char *key, size_t len, uint64_t *h1, uint64_t *h2)
+{
+    uint64_t h = 14695981039346656037ULL;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= (unsigned char)key[i];
+        h *= 1099511628211ULL;
+    }
+
+    *h1 = mix(h);
+    *h2 = mix(h ^ 0x9e3779b97f4a7c15ULL) | 1;
+}
+
+/* an empty filter sized for nkeys paths */
+int bee_bloom_init(struct bee_bloom *bf, uint64_t nkeys)
+{
+    struct bee_bloom_header *hdr;
+    uint64_t nbits;
+
+    assert(bf);
+
+    memset(bf, 0, sizeof(*bf));
+
+    nbits = (nkeys * BEE_BLOOM_BITS_PER_KEY + 63) / 64 * 64;
+    if (!nbits)
+        nbits = 64;
+
+    bf->size = sizeof(*hdr) + nbits / 8;
+    bf->map  = calloc(1, bf->size);
+    if (!bf->map)
+        return 0;
+
+    hdr = bf->header = bf->map;
+    bf->bits = (uint64_t *)(hdr + 1);
+
+    memcpy(hdr->magic, BEE_BLOOM_MAGIC, sizeof(hdr->magic));
+    hdr->version   = BEE_BLOOM_VERSION;
+    hdr->byteorder = BEE_BLOOM_BYTEORDER;
+    hdr->nhashes   = BEE_BLOOM_HASHES;
+    hdr->nbits     = nbits;
+
+    return 1;
+}
+
+void bee_bloom_add(struct bee_bloom *bf, const char *key, size_t len)
+{
+    uint64_t h1, h2, bit;
+    uint32_t i;
+
+    assert(bf);
+    assert(key);
+
+    hash_key(key, len, &h1, &h2);
+
+    for (i = 0; i < bf->header->nhashes; i++) {
+        bit = (h1 + i * h2) % bf->header->nbits;
+        bf->bits[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+
+    bf->header->nkeys++;
+}
+
+/*
+ * RETURN: 0 if key was never added
+ *         1 if key may have been added
+ */
+int bee_bloom_test(struct bee_bloom *bf, const char *key, size_t len)
+{
+    uint64_t h1, h2, bit;
+    uint32_t i;
+
+    assert(bf);
+    assert(key);
+
+    hash_key(key, len, &h1, &h2);
+
+    for (i = 0; i < bf->header->nhashes; i++) {
+        bit = (h1 + i * h2) % bf->header->nbits;
+        if (!(bf->bits[bit / 64] & ((uint64_t)1 << (bit % 64))))
+            return 0;
+    }
+
+    return 1;
+}
+
+/* replace <file> through bee_output with flags */
+int bee_bloom_write(struct bee_bloom *bf, char *file, int flags)
+{
+    struct bee_output out;
+    FILE *fh;
+
+    assert(bf);
+    assert(file);
+
+    fh = bee_output_open(&out, file, flags);
+    if (!fh)
+        return 0;
+
+    if (fwrite(bf->map, bf->size, 1, fh) != 1) {
+        bee_output_abort(&out);
+        return 0;
+    }
+
+    return bee_output_commit(&out);
+}
+
+/*
+ * map <file>
+ *
+ * RETURN: 1 on success
+ *         0 on error; errno is EINVAL if <file> is no usable filter
+ */
+int bee_bloom_open(struct bee_bloom *bf, char *file)
+{
+    struct bee_bloom_header *hdr;
+    struct stat st;
+    int fd, err;
+
+    assert(bf);
+    assert(file);
+
+    memset(bf, 0, sizeof(*bf));
+
+    fd = open(file, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    if (fstat(fd, &st) < 0)
+        goto error;
+
+    if ((size_t)st.st_size < sizeof(*hdr)) {
+        errno = EINVAL;
+        goto error;
+    }
+
+    bf->size = st.st_size;
+    bf->map  = mmap(NULL, bf->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (bf->map == MAP_FAILED) {
+        bf->map = NULL;
+        goto error;
+    }
+
+    bf->mapped = 1;
+
+    hdr = bf->header = bf->map;
+    bf->bits = (uint64_t *)(hdr + 1);
+
+    if (memcmp(hdr->magic, BEE_BLOOM_MAGIC, sizeof(hdr->magic))
+        || hdr->version   != BEE_BLOOM_VERSION
+        || hdr->byteorder != BEE_BLOOM_BYTEORDER
+        || !hdr->nhashes || hdr->nhashes > 64
+        || !hdr->nbits || hdr->nbits % 64
+        || hdr->nbits / 8 != bf->size - sizeof(*hdr)) {
+        errno = EINVAL;
+        goto error;
+    }
+
+    close(fd);
+
+    return 1;
+
+error:
+    err = errno;
+    close(fd);
+    bee_bloom_free(bf);
+    errno = err;
+
+    return 0;
+}
+
+void bee_bloom_free(struct bee_bloom *bf)
+{
+    assert(bf);
+
+    if (bf->mapped)
+        munmap(bf->map, bf->size);
+    else
+        free(bf->map);
+
+    memset(bf, 0, sizeof(*bf));
+}
@@ -0,0 +1,78 @@
+/*
+** bee_bloom - Bloom filters of the paths of a package
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_BLOOM_H
+#define BEE_BLOOM_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * layout of <cachedir>/<pkg>.bf (host byte order):
+ *
+ *   header
+ *   bits[nbits / 64]
+ *
+ * a path is in the filter if the nhashes bits derived from its hash by
+ * double hashing are set. a filter never rejects a path that was added,
+ * a path that was not is let through with about
+ * (1 - e^(-nhashes * nkeys / nbits))^nhashes.
+ */
+
+#define BEE_BLOOM_MAGIC     "BEEBLOOM"
+#define BEE_BLOOM_VERSION   1
+#define BEE_BLOOM_BYTEORDER 0x01020304
+
+/* ~0.8% false positives */
+#define BEE_BLOOM_BITS_PER_KEY 10
+#define BEE_BLOOM_HASHES       7
+
+struct bee_bloom_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+    uint32_t nhashes;
+    uint32_t reserved;
+    uint64_t nbits;
+    uint64_t nkeys;
+};
+
+struct bee_bloom {
+    void   *map;
+    size_t size;
+    int    mapped;
+
+    struct bee_bloom_header *header;
+    uint64_t                *bits;
+};
+
+int  bee_bloom_init(struct bee_bloom *bf, uint64_t nkeys);
+void bee_bloom_add(struct bee_bloom *bf, const char *key, size_t len);
+int  bee_bloom_test(struct bee_bloom *bf, const char *key, size_t len);
+
+int  bee_bloom_write(struct bee_bloom *bf, char *file, int flags);
+int  bee_bloom_open(struct bee_bloom *bf, char *file);
+void bee_bloom_free(struct bee_bloom *bf);
+
+#endif
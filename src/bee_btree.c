@@ -0,0 +1,405 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "bee_btree.h"
+
+#define BEE_BTREE_UNIQUE_FLAGS (BEE_TREE_FLAG_UNIQUE|BEE_TREE_FLAG_UNIQUE_DATA)
+
+static void *bee_btree_generate_key_default(const void *data)
+{
+    assert(data);
+
+    return (void *)data;
+}
+
+static int bee_btree_compare_key_default(void *a, void *b)
+{
+    assert(a);
+    assert(b);
+
+    return strcmp(a, b);
+}
+
+static void bee_btree_print_key_default(void *key)
+{
+    assert(key);
+
+    fputs(key, stdout);
+}
+
+struct bee_btree *bee_btree_allocate(void)
+{
+    struct bee_btree *t;
+
+    if(!(t = calloc(1, sizeof(*t))))
+        return NULL;
+
+    t->generate_key = &bee_btree_generate_key_default;
+    t->compare_key  = &bee_btree_compare_key_default;
+    t->print_key    = &bee_btree_print_key_default;
+
+    return t;
+}
+
+static struct bee_btree_node *bee_btree_node_allocate(int leaf)
+{
+    struct bee_btree_node *n;
+    size_t size;
+
+    size = sizeof(*n);
+
+    if (!leaf)
+        size += (BEE_BTREE_MAX_KEYS + 1) * sizeof(n->child[0]);
+
+    if (!(n = calloc(1, size)))
+        return NULL;
+
+    n->leaf = leaf;
+
+    return n;
+}
+
+static void bee_btree_node_free(struct bee_btree *tree, struct bee_btree_node *node)
+{
+    int i;
+
+    if (!node)
+        return;
+
+    assert(tree);
+
+    for (i = 0; i < node->nkeys; i++) {
+        if (!node->leaf)
+            bee_btree_node_free(tree, node->child[i]);
+
+        if (tree->free_data && node->data[i])
+            tree->free_data(node->data[i]);
+
+        if (tree->free_key && node->key[i])
+            tree->free_key(node->key[i]);
+    }
+
+    if (!node->leaf)
+        bee_btree_node_free(tree, node->child[node->nkeys]);
+
+    free(node);
+}
+
+void bee_btree_free(struct bee_btree *tree)
+{
+    assert(tree);
+    bee_btree_node_free(tree, tree->root);
+    free(tree);
+}
+
+/* same ordering and dupe semantics as bee_tree_compare_nodes() */
+static int bee_btree_compare(struct bee_btree *tree, void *akey, void *adata, void *bkey, void *bdata, int *dupe)
+{
+    int cmp;
+
+    *dupe = 0;
+
+    cmp = tree->compare_key(akey, bkey);
+
+    if ((cmp == 0) && (tree->flags & BEE_BTREE_UNIQUE_FLAGS)) {
+        if (!(tree->flags & BEE_TREE_FLAG_UNIQUE_DATA)) {
+            *dupe = 1;
+            return 0;
+        }
+    }
+
+    if ((cmp == 0) && tree->flags & (BEE_TREE_FLAG_UNIQUE_DATA|BEE_TREE_FLAG_COMPARE_DATA_ON_EQUAL_KEY)) {
+
+        assert(tree->compare_data);
+
+        cmp = tree->compare_data(adata, bdata);
+
+        if (cmp == 0 && (tree->flags & BEE_TREE_FLAG_UNIQUE_DATA))
+            *dupe = 1;
+    }
+
+    return cmp;
+}
+
+/*
+ * find the slot for key/data in node: the index of the first element that
+ * is greater. equal elements are skipped so dupes keep insertion order.
+ *
+ * RETURN: slot or -1 if an equal element is rejected by the unique flags
+ */
+static int bee_btree_node_slot(struct bee_btree *tree, struct bee_btree_node *node, void *key, void *data)
+{
+    int lo, hi, mid;
+    int dupe;
+
+    lo = 0;
+    hi = node->nkeys;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+
+        if (bee_btree_compare(tree, key, data, node->key[mid], node->data[mid], &dupe) < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    /* an element equal to key can only be the one left of the slot */
+    if (lo && (tree->flags & BEE_BTREE_UNIQUE_FLAGS)) {
+        bee_btree_compare(tree, key, data, node->key[lo-1], node->data[lo-1], &dupe);
+        if (dupe)
+            return -1;
+    }
+
+    return lo;
+}
+
+/* split the full child i of parent and move its median up into parent */
+static int bee_btree_split_child(struct bee_btree_node *parent, int i)
+{
+    struct bee_btree_node *left, *right;
+    const int t = BEE_BTREE_ORDER;
+
+    left = parent->child[i];
+
+    assert(left->nkeys == BEE_BTREE_MAX_KEYS);
+    assert(parent->nkeys < BEE_BTREE_MAX_KEYS);
+
+    right = bee_btree_node_allocate(left->leaf);
+    if (!right)
+        return 0;
+
+    memcpy(right->key,  &left->key[t],  (t-1) * sizeof(left->key[0]));
+    memcpy(right->data, &left->data[t], (t-1) * sizeof(left->data[0]));
+
+    if (!left->leaf)
+        memcpy(right->child, &left->child[t], t * sizeof(left->child[0]));
+
+    right->nkeys = t-1;
+    left->nkeys  = t-1;
+
+    memmove(&parent->key[i+1],   &parent->key[i],   (parent->nkeys - i) * sizeof(parent->key[0]));
+    memmove(&parent->data[i+1],  &parent->data[i],  (parent->nkeys - i) * sizeof(parent->data[0]));
+    memmove(&parent->child[i+2], &parent->child[i+1], (parent->nkeys - i) * sizeof(parent->child[0]));
+
+    parent->key[i]      = left->key[t-1];
+    parent->data[i]     = left->data[t-1];
+    parent->child[i+1]  = right;
+    parent->nkeys++;
+
+    return 1;
+}
+
+/*
+ * insert key/data in a single pass from the root down: full nodes are
+ * split on the way so there always is room for the new element
+ */
+static int bee_btree_insert_element(struct bee_btree *tree, void *key, void *data)
+{
+    struct bee_btree_node *node, *root;
+    int i;
+    int dupe;
+
+    if (!tree->root) {
+        if (!(tree->root = bee_btree_node_allocate(1)))
+            return -1;
+    }
+
+    if (tree->root->nkeys == BEE_BTREE_MAX_KEYS) {
+        if (!(root = bee_btree_node_allocate(0)))
+            return -1;
+
+        root->child[0] = tree->root;
+
+        if (!bee_btree_split_child(root, 0)) {
+            free(root);
+            return -1;
+        }
+
+        tree->root = root;
+    }
+
+    node = tree->root;
+
+    while (1) {
+        i = bee_btree_node_slot(tree, node, key, data);
+        if (i < 0)
+            return 0;
+
+        if (node->leaf)
+            break;
+
+        if (node->child[i]->nkeys == BEE_BTREE_MAX_KEYS) {
+            if (!bee_btree_split_child(node, i))
+                return -1;
+
+            /* the median moved up to slot i: choose a side */
+            if (bee_btree_compare(tree, key, data, node->key[i], node->data[i], &dupe) >= 0) {
+                if (dupe)
+                    return 0;
+                i++;
+            }
+        }
+
+        node = node->child[i];
+    }
+
+    memmove(&node->key[i+1],  &node->key[i],  (node->nkeys - i) * sizeof(node->key[0]));
+    memmove(&node->data[i+1], &node->data[i], (node->nkeys - i) * sizeof(node->data[0]));
+
+    node->key[i]  = key;
+    node->data[i] = data;
+    node->nkeys++;
+
+    tree->count++;
+
+    return 1;
+}
+
+/*
+ * RETURN: data on success
+ *         NULL on error; errno is EEXIST if data was rejected as dupe
+ */
+void *bee_btree_insert(struct bee_btree *tree, void *data)
+{
+    void *key;
+    int res;
+
+    assert(tree);
+    assert(data);
+
+    assert(tree->generate_key);
+    assert(tree->compare_key);
+
+    errno = 0;
+
+    key = tree->generate_key(data);
+    if (!key)
+        return NULL;
+
+    res = bee_btree_insert_element(tree, key, data);
+    if (res > 0)
+        return data;
+
+    if (tree->free_key)
+        tree->free_key(key);
+
+    if (res == 0)
+        errno = EEXIST;
+
+    return NULL;
+}
+
+/* search key in tree and return it's data */
+void *bee_btree_search(struct bee_btree *tree, void *key)
+{
+    struct bee_btree_node *node;
+    int lo, hi, mid;
+    int cmp;
+
+    assert(tree);
+    assert(key);
+
+    assert(tree->compare_key);
+
+    node = tree->root;
+
+    while (node) {
+        lo = 0;
+        hi = node->nkeys;
+
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            cmp = tree->compare_key(key, node->key[mid]);
+
+            if (!cmp)
+                return node->data[mid];
+
+            if (cmp < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+
+        node = node->leaf ? NULL : node->child[lo];
+    }
+
+    return NULL;
+}
+
+static void bee_btree_element_print(struct bee_btree *tree, struct bee_btree_node *node, int i, int depth)
+{
+    int d;
+
+    assert(tree->print || tree->print_key);
+
+    for (d = 0 ; d < depth ; d++)
+        putchar('-');
+
+    if (tree->print)
+        tree->print(node->key[i], node->data[i]);
+    else
+        tree->print_key(node->key[i]);
+}
+
+static void bee_btree_node_print(struct bee_btree *tree, struct bee_btree_node *node, int depth, int plain)
+{
+    int i;
+
+    if (!node)
+        return;
+
+    for (i = 0; i < node->nkeys; i++) {
+        if (!node->leaf)
+            bee_btree_node_print(tree, node->child[i], depth+1, plain);
+
+        bee_btree_element_print(tree, node, i, plain ? 0 : depth);
+    }
+
+    if (!node->leaf)
+        bee_btree_node_print(tree, node->child[node->nkeys], depth+1, plain);
+}
+
+void bee_btree_print(struct bee_btree *tree)
+{
+    assert(tree);
+
+    bee_btree_node_print(tree, tree->root, 0, 0);
+}
+
+void bee_btree_print_plain(struct bee_btree *tree)
+{
+    assert(tree);
+
+    bee_btree_node_print(tree, tree->root, 0, 1);
+}
+
+int bee_btree_set_flags(struct bee_btree *tree, int flags)
+{
+    int oflags;
+
+    assert(tree);
+    assert(flags);
+
+    oflags = tree->flags;
+    tree->flags |= flags;
+
+    return oflags;
+}
+
+int bee_btree_unset_flags(struct bee_btree *tree, int flags)
+{
+    int oflags;
+
+    assert(tree);
+    assert(flags);
+
+    oflags = tree->flags;
+    tree->flags &= ~flags;
+
+    return oflags;
+}
@@ -0,0 +1,55 @@
+#ifndef _BEE_BEE_BTREE_H
+#define _BEE_BEE_BTREE_H 1
+
+#include <stddef.h>
+
+/* bee_btree uses the same flags as bee_tree */
+#include "bee_tree.h"
+
+/* minimum degree: every node but the root holds ORDER-1 .. 2*ORDER-1 keys */
+#define BEE_BTREE_ORDER    16
+#define BEE_BTREE_MAX_KEYS (2*BEE_BTREE_ORDER-1)
+
+struct bee_btree {
+    struct bee_btree_node *root;
+
+    int flags;
+
+    size_t count;
+
+    void   (*free_data)(void *data);
+
+    void * (*generate_key)(const void *data);
+    void   (*free_key)(void *key);
+
+    int    (*compare_key)(void *a, void *b);
+    int    (*compare_data)(void *a, void *b);
+
+    void   (*print_key)(void *key);
+    void   (*print)(void *key, void *data);
+};
+
+/* leaf nodes are allocated without the child array */
+struct bee_btree_node {
+    unsigned short nkeys;
+    unsigned char  leaf;
+
+    void *key[BEE_BTREE_MAX_KEYS];
+    void *data[BEE_BTREE_MAX_KEYS];
+
+    struct bee_btree_node *child[];
+};
+
+struct bee_btree *bee_btree_allocate(void);
+void bee_btree_free(struct bee_btree *tree);
+void *bee_btree_insert(struct bee_btree *tree, void *data);
+
+void *bee_btree_search(struct bee_btree *tree, void *key);
+
+void bee_btree_print(struct bee_btree *tree);
+void bee_btree_print_plain(struct bee_btree *tree);
+
+int bee_btree_set_flags(struct bee_btree *tree, int flags);
+int bee_btree_unset_flags(struct bee_btree *tree, int flags);
+
+#endif
@@ -0,0 +1,1257 @@
+/*
+** bee_inventory - memory mapped binary index of bee's INVENTORY
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <regex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bee_inventory.h"
+#include "bee_output.h"
+
+#define ALIGN8(x) (((x) + 7) & ~(uint64_t)7)
+
+/* one inventory line while building the index */
+struct index_line {
+    char     *pkg;
+    uint32_t pkglen;
+    char     *path;
+};
+
+struct index_sort {
+    struct index_line *line;
+    uint32_t          nr;
+};
+
+static uint64_t hash_path(const char *path)
+{
+    const unsigned char *s = (const unsigned char *)path;
+    uint64_t h = 14695981039346656037ULL;
+
+    while (*s) {
+        h ^= *(s++);
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+static int compare_pkg(const void *a, const void *b)
+{
+    const struct index_sort *x = a, *y = b;
+    uint32_t len;
+    int cmp;
+
+    len = x->line->pkglen < y->line->pkglen ? x->line->pkglen : y->line->pkglen;
+
+    cmp = memcmp(x->line->pkg, y->line->pkg, len);
+    if (cmp)
+        return cmp;
+
+    if (x->line->pkglen != y->line->pkglen)
+        return x->line->pkglen < y->line->pkglen ? -1 : 1;
+
+    return x->nr < y->nr ? -1 : (x->nr > y->nr);
+}
+
+static int compare_path(const void *a, const void *b)
+{
+    const struct index_sort *x = a, *y = b;
+    int cmp;
+
+    cmp = strcmp(x->line->path, y->line->path);
+    if (cmp)
+        return cmp;
+
+    return x->nr < y->nr ? -1 : (x->nr > y->nr);
+}
+
+/* read the whole file, the returned buffer is NUL terminated */
+static char *read_file(char *fname, struct stat *st)
+{
+    char *buf;
+    size_t done = 0;
+    ssize_t r;
+    int fd;
+
+    fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "bee-inventory: %s: %m\n", fname);
+        return NULL;
+    }
+
+    if (fstat(fd, st) < 0) {
+        fprintf(stderr, "bee-inventory: %s: %m\n", fname);
+        close(fd);
+        return NULL;
+    }
+
+    buf = malloc(st->st_size + 1);
+    if (!buf) {
+        perror("malloc");
+        close(fd);
+        return NULL;
+    }
+
+    while (done < (size_t)st->st_size) {
+        r = read(fd, buf + done, st->st_size - done);
+        if (r <= 0) {
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (!r)
+                errno = EIO;
+            fprintf(stderr, "bee-inventory: %s: %m\n", fname);
+            free(buf);
+            close(fd);
+            return NULL;
+        }
+        done += r;
+    }
+
+    buf[done] = '\0';
+    close(fd);
+
+    return buf;
+}
+
+static int write_table(FILE *fh, void *table, size_t size, uint64_t *offset)
+{
+    static const char zero[8];
+    uint64_t pad;
+
+    pad = ALIGN8(*offset) - *offset;
+
+    if (pad && fwrite(zero, pad, 1, fh) != 1)
+        return 0;
+
+    if (size && fwrite(table, size, 1, fh) != 1)
+        return 0;
+
+    *offset += pad + size;
+
+    return 1;
+}
+
+/*
+ * radix trie
+ *
+ * the trie is built uncompressed from the paths sorted by components,
+ * so the path of each node is a prefix of the paths that follow it until
+ * a different component comes up. owners are summed up from the leaves
+ * and chains of nodes without a path are merged before the trie is
+ * written breadth first so the children of a node end up adjacent.
+ */
+
+struct trie_path {
+    const char *path;
+    uint32_t   nr;
+};
+
+struct trie_build {
+    const char *label;
+    uint32_t   length;
+    uint32_t   path;
+    uint32_t   parent;
+    uint32_t   first;
+    uint32_t   last;
+    uint32_t   next;
+    uint32_t   nchildren;
+    uint32_t   owner;
+    uint32_t   index;
+};
+
+struct trie_component {
+    const char *s;
+    uint32_t   len;
+    uint32_t   node;
+};
+
+#define TRIE_NONE UINT32_MAX
+
+/* like strcmp but '/' sorts before any other character */
+static int compare_components(const void *a, const void *b)
+{
+    const unsigned char *x = (const unsigned char *)((const struct trie_path *)a)->path;
+    const unsigned char *y = (const unsigned char *)((const struct trie_path *)b)->path;
+    int cx, cy;
+
+    while (*x && *x == *y) {
+        x++;
+        y++;
+    }
+
+    cx = (*x == '/') ? 1 : (*x ? *x + 1 : 0);
+    cy = (*y == '/') ? 1 : (*y ? *y + 1 : 0);
+
+    return cx - cy;
+}
+
+static uint32_t owner_add(uint32_t owner, uint32_t pkg)
+{
+    if (owner == BEE_INVENTORY_NOPKG || owner == pkg)
+        return pkg;
+
+    if (pkg == BEE_INVENTORY_NOPKG)
+        return owner;
+
+    return BEE_INVENTORY_MANYPKGS;
+}
+
+/* next component of *s or 0 at the end of the path */
+static uint32_t next_component(const char **s, const char *end)
+{
+    const char *p = *s;
+
+    while (p < end && *p == '/')
+        p++;
+
+    *s = p;
+
+    while (p < end && *p != '/')
+        p++;
+
+    return p - *s;
+}
+
+static int build_trie(char *buf, struct bee_inventory_path *paths, uint64_t npaths,
+                      uint32_t *owners, struct bee_inventory_record *records,
+                      struct bee_inventory_node **nodesp, uint64_t *nnodesp)
+{
+    struct trie_path *order = NULL;
+    struct trie_build *t = NULL, *n, *c;
+    struct trie_component *stack = NULL;
+    struct bee_inventory_node *nodes = NULL;
+    uint32_t *queue = NULL;
+    size_t nt = 0, tsize = 0, depth, k, stacksize = 0;
+    uint64_t i, j, head, tail;
+    const char *s, *end;
+    uint32_t len, id;
+    void *tmp;
+    int res = 0;
+
+    order = calloc(npaths ? npaths : 1, sizeof(*order));
+    if (!order) {
+        perror("calloc");
+        return 0;
+    }
+
+    for (i = 0; i < npaths; i++) {
+        order[i].path = buf + paths[i].name;
+        order[i].nr   = i;
+    }
+
+    qsort(order, npaths, sizeof(*order), compare_components);
+
+    tsize = npaths + 64;
+    t = calloc(tsize, sizeof(*t));
+    stacksize = 64;
+    stack = calloc(stacksize, sizeof(*stack));
+    if (!t || !stack) {
+        perror("calloc");
+        goto out;
+    }
+
+    /* the root */
+    t[0].parent = t[0].first = t[0].last = t[0].next = TRIE_NONE;
+    t[0].owner  = BEE_INVENTORY_NOPKG;
+    nt = 1;
+
+    stack[0].node = 0;
+    depth = 0;
+
+    for (i = 0; i < npaths; i++) {
+        s   = order[i].path;
+        end = s + paths[order[i].nr].length;
+
+        /* keep the components shared with the previous path */
+        for (k = 0; ; k++) {
+            len = next_component(&s, end);
+            if (!len || k == depth || stack[k+1].len != len || memcmp(stack[k+1].s, s, len))
+                break;
+            s += len;
+        }
+
+        depth = k;
+
+        for (; len; s += len, len = next_component(&s, end)) {
+            if (depth + 2 > stacksize) {
+                stacksize *= 2;
+                tmp = realloc(stack, stacksize * sizeof(*stack));
+                if (!tmp) {
+                    perror("realloc");
+                    goto out;
+                }
+                stack = tmp;
+            }
+
+            if (nt == tsize || nt == UINT32_MAX - 2) {
+                if (nt == UINT32_MAX - 2) {
+                    fputs("bee-inventory: Too many path components.\n", stderr);
+                    goto out;
+                }
+                tsize *= 2;
+                tmp = realloc(t, tsize * sizeof(*t));
+                if (!tmp) {
+                    perror("realloc");
+                    goto out;
+                }
+                t = tmp;
+            }
+
+            id = nt++;
+            n  = &t[id];
+            c  = &t[stack[depth].node];
+
+            n->label  = s;
+            n->length = len;
+            n->path   = 0;
+            n->parent = stack[depth].node;
+            n->first  = n->last = n->next = TRIE_NONE;
+            n->nchildren = 0;
+            n->owner  = BEE_INVENTORY_NOPKG;
+
+            if (c->last == TRIE_NONE)
+                c->first = id;
+            else
+                t[c->last].next = id;
+            c->last = id;
+            c->nchildren++;
+
+            depth++;
+            stack[depth].s    = s;
+            stack[depth].len  = len;
+            stack[depth].node = id;
+        }
+
+        /* the first of paths that only differ by repeated slashes wins */
+        n = &t[stack[depth].node];
+        if (!n->path)
+            n->path = order[i].nr + 1;
+    }
+
+    /* owners from the leaves up: parents are created before their children */
+    for (id = nt; id-- > 0; ) {
+        n = &t[id];
+
+        if (n->path) {
+            for (j = 0; j < paths[n->path-1].count; j++)
+                n->owner = owner_add(n->owner, records[owners[paths[n->path-1].first + j]].pkg);
+        }
+
+        if (n->parent != TRIE_NONE)
+            t[n->parent].owner = owner_add(t[n->parent].owner, n->owner);
+    }
+
+    /* merge chains: the only child of a node without path was created by the same path */
+    for (id = 1; id < nt; id++) {
+        n = &t[id];
+        if (n->length == 0)
+            continue;
+
+        while (!n->path && n->nchildren == 1) {
+            c = &t[n->first];
+
+            n->length    = c->label + c->length - n->label;
+            n->path      = c->path;
+            n->first     = c->first;
+            n->last      = c->last;
+            n->nchildren = c->nchildren;
+
+            c->length = 0;
+        }
+    }
+
+    /* breadth first */
+    nodes = calloc(nt, sizeof(*nodes));
+    queue = calloc(nt, sizeof(*queue));
+    if (!nodes || !queue) {
+        perror("calloc");
+        goto out;
+    }
+
+    queue[0] = 0;
+    t[0].index = 0;
+    head = 0;
+    tail = 1;
+
+    while (head < tail) {
+        n = &t[queue[head]];
+
+        nodes[head].label     = n->label ? n->label - buf : 0;
+        nodes[head].length    = n->length;
+        nodes[head].path      = n->path;
+        nodes[head].children  = tail;
+        nodes[head].nchildren = n->nchildren;
+        nodes[head].owner     = n->owner;
+
+        for (id = n->first; id != TRIE_NONE; id = t[id].next)
+            queue[tail++] = id;
+
+        head++;
+    }
+
+    *nodesp  = nodes;
+    *nnodesp = tail;
+    nodes    = NULL;
+    res      = 1;
+
+out:
+    free(queue);
+    free(nodes);
+    free(stack);
+    free(t);
+    free(order);
+
+    return res;
+}
+
+/*
+ * build <index> for the sorted text <inventory> and replace it through
+ * bee_output with flags
+ *
+ * RETURN: 1 on success, 0 on error
+ */
+int bee_inventory_index_write(char *inventory, char *index, int flags)
+{
+    struct stat st;
+    struct bee_inventory_header hdr;
+    struct bee_inventory_record *records = NULL;
+    struct bee_inventory_pkg *pkgs = NULL;
+    struct bee_inventory_path *paths = NULL;
+    uint32_t *owners = NULL, *hash = NULL, *recnr = NULL;
+    struct bee_inventory_node *nodes = NULL;
+    struct index_line *lines = NULL;
+    struct index_sort *order = NULL;
+    char *buf, *p, *end, *nl, *names = NULL, *pathnames = NULL;
+    uint64_t nlines = 0, npkgs = 0, npaths = 0, nhash, nnodes = 0, namesize = 0;
+    uint64_t pathnamesize = 0;
+    uint64_t i, h, off;
+    struct bee_output out;
+    FILE *fh;
+    int spaces, res = 0;
+
+    assert(inventory);
+    assert(index);
+
+    buf = read_file(inventory, &st);
+    if (!buf)
+        return 0;
+
+    end = buf + st.st_size;
+
+    for (p = buf; p < end; p = nl + 1) {
+        nl = memchr(p, '\n', end - p);
+        nlines++;
+        if (!nl)
+            break;
+    }
+
+    if (nlines > UINT32_MAX - 1) {
+        fprintf(stderr, "bee-inventory: %s: Too many lines.\n", inventory);
+        goto out;
+    }
+
+    lines   = calloc(nlines ? nlines : 1, sizeof(*lines));
+    order   = calloc(nlines ? nlines : 1, sizeof(*order));
+    records = calloc(nlines ? nlines : 1, sizeof(*records));
+    recnr   = calloc(nlines ? nlines : 1, sizeof(*recnr));
+    owners  = calloc(nlines ? nlines : 1, sizeof(*owners));
+    pkgs    = calloc(nlines ? nlines : 1, sizeof(*pkgs));
+    paths   = calloc(nlines ? nlines : 1, sizeof(*paths));
+    names   = malloc(st.st_size + 2);
+    if (!lines || !order || !records || !recnr || !owners || !pkgs || !paths || !names) {
+        perror("calloc");
+        goto out;
+    }
+
+    for (i = 0, p = buf; i < nlines; i++, p = nl + 1) {
+        nl = memchr(p, '\n', end - p);
+        if (!nl)
+            nl = end;
+        *nl = '\0';
+
+        lines[i].pkg = p;
+        lines[i].pkglen = strcspn(p, " ");
+
+        for (spaces = 0; spaces < 7 && p; spaces++) {
+            p = strchr(p, ' ');
+            if (p)
+                p++;
+        }
+
+        if (!p) {
+            fprintf(stderr, "bee-inventory: %s: line %lu: Invalid inventory line.\n",
+                    inventory, (unsigned long)i + 1);
+            goto out;
+        }
+
+        lines[i].path = p;
+    }
+
+    /* records grouped by package */
+    for (i = 0; i < nlines; i++) {
+        order[i].line = &lines[i];
+        order[i].nr   = i;
+    }
+
+    qsort(order, nlines, sizeof(*order), compare_pkg);
+
+    for (i = 0; i < nlines; i++) {
+        struct index_line *l = order[i].line;
+
+        if (!i || l->pkglen != order[i-1].line->pkglen
+               || memcmp(l->pkg, order[i-1].line->pkg, l->pkglen)) {
+            pkgs[npkgs].name  = namesize;
+            pkgs[npkgs].first = i;
+            memcpy(names + namesize, l->pkg, l->pkglen);
+            namesize += l->pkglen;
+            names[namesize++] = '\0';
+            npkgs++;
+        }
+        pkgs[npkgs-1].count++;
+
+        records[i].line   = l->pkg - buf;
+        records[i].length = strlen(l->pkg);
+        records[i].pkg    = npkgs - 1;
+        recnr[order[i].nr] = i;
+    }
+
+    /* owners grouped by path */
+    for (i = 0; i < nlines; i++) {
+        order[i].line = &lines[i];
+        order[i].nr   = i;
+    }
+
+    qsort(order, nlines, sizeof(*order), compare_path);
+
+    for (i = 0; i < nlines; i++) {
+        struct index_line *l = order[i].line;
+
+        if (!i || strcmp(l->path, order[i-1].line->path)) {
+            paths[npaths].name   = l->path - buf;
+            paths[npaths].length = strlen(l->path);
+            paths[npaths].first  = i;
+            npaths++;
+        }
+        paths[npaths-1].count++;
+
+        owners[i] = recnr[order[i].nr];
+        records[owners[i]].path = npaths - 1;
+    }
+
+    /* terminate strings even if there are no packages */
+    names[namesize++] = '\0';
+
+    for (nhash = 1; nhash < 2 * npaths; nhash <<= 1)
+        ;
+
+    hash = calloc(nhash, sizeof(*hash));
+    if (!hash) {
+        perror("calloc");
+        goto out;
+    }
+
+    for (i = 0; i < npaths; i++) {
+        h = hash_path(buf + paths[i].name) & (nhash - 1);
+        while (hash[h])
+            h = (h + 1) & (nhash - 1);
+        hash[h] = i + 1;
+    }
+
+    if (!build_trie(buf, paths, npaths, owners, records, &nodes, &nnodes))
+        goto out;
+
+    for (i = 0; i < npaths; i++)
+        pathnamesize += paths[i].length + 1;
+
+    if (pathnamesize > UINT32_MAX) {
+        fprintf(stderr, "bee-inventory: %s: Too many paths.\n", inventory);
+        goto out;
+    }
+
+    pathnames = malloc(pathnamesize ? pathnamesize : 1);
+    if (!pathnames) {
+        perror("malloc");
+        goto out;
+    }
+
+    for (i = 0, off = 0; i < npaths; i++) {
+        paths[i].pathname = off;
+        memcpy(pathnames + off, buf + paths[i].name, paths[i].length + 1);
+        off += paths[i].length + 1;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, BEE_INVENTORY_MAGIC, sizeof(hdr.magic));
+    hdr.version   = BEE_INVENTORY_VERSION;
+    hdr.byteorder = BEE_INVENTORY_BYTEORDER;
+
+    hdr.inventory_size       = st.st_size;
+    hdr.inventory_mtime      = st.st_mtim.tv_sec;
+    hdr.inventory_mtime_nsec = st.st_mtim.tv_nsec;
+    hdr.inventory_ino        = st.st_ino;
+
+    hdr.nrecords = nlines;
+    hdr.npkgs    = npkgs;
+    hdr.npaths   = npaths;
+    hdr.nhash    = nhash;
+    hdr.nnodes   = nnodes;
+
+    hdr.pathnamesize = pathnamesize;
+
+    off = sizeof(hdr);
+    hdr.records = off = ALIGN8(off);
+    off += nlines * sizeof(*records);
+    hdr.pkgs    = off = ALIGN8(off);
+    off += npkgs * sizeof(*pkgs);
+    hdr.paths   = off = ALIGN8(off);
+    off += npaths * sizeof(*paths);
+    hdr.owners  = off = ALIGN8(off);
+    off += nlines * sizeof(*owners);
+    hdr.hash    = off = ALIGN8(off);
+    off += nhash * sizeof(*hash);
+    hdr.nodes   = off = ALIGN8(off);
+    off += nnodes * sizeof(*nodes);
+    hdr.pathnames = off = ALIGN8(off);
+    off += pathnamesize;
+    hdr.strings = off = ALIGN8(off);
+    off += namesize;
+    hdr.size    = off;
+
+    fh = bee_output_open(&out, index, flags);
+    if (!fh) {
+        fprintf(stderr, "bee-inventory: %s: %m\n", index);
+        goto out;
+    }
+
+    off = 0;
+    res = write_table(fh, &hdr, sizeof(hdr), &off)
+       && write_table(fh, records, nlines * sizeof(*records), &off)
+       && write_table(fh, pkgs, npkgs * sizeof(*pkgs), &off)
+       && write_table(fh, paths, npaths * sizeof(*paths), &off)
+       && write_table(fh, owners, nlines * sizeof(*owners), &off)
+       && write_table(fh, hash, nhash * sizeof(*hash), &off)
+       && write_table(fh, nodes, nnodes * sizeof(*nodes), &off)
+       && write_table(fh, pathnames, pathnamesize, &off)
+       && write_table(fh, names, namesize, &off);
+
+    if (res) {
+        res = bee_output_commit(&out);
+    } else {
+        bee_output_abort(&out);
+    }
+
+    if (!res)
+        fprintf(stderr, "bee-inventory: %s: %m\n", index);
+
+out:
+    free(pathnames);
+    free(nodes);
+    free(hash);
+    free(names);
+    free(paths);
+    free(pkgs);
+    free(owners);
+    free(recnr);
+    free(records);
+    free(order);
+    free(lines);
+    free(buf);
+
+    return res;
+}
+
+static int check_table(struct bee_inventory *inv, uint64_t offset, uint64_t n, size_t size)
+{
+    if (offset % 8 || offset > inv->size)
+        return 0;
+
+    if (n > (inv->size - offset) / size)
+        return 0;
+
+    return 1;
+}
+
+/*
+ * map <index> and the text <inventory> it was built from
+ *
+ * RETURN: 1 on success
+ *         0 on error; errno is ESTALE if <index> does not match <inventory>
+ */
+int bee_inventory_open(struct bee_inventory *inv, char *inventory, char *index)
+{
+    struct bee_inventory_header *hdr;
+    struct stat st, ist;
+    int fd, ifd;
+
+    assert(inv);
+    assert(inventory);
+    assert(index);
+
+    memset(inv, 0, sizeof(*inv));
+
+    ifd = open(inventory, O_RDONLY);
+    if (ifd < 0)
+        return 0;
+
+    fd = open(index, O_RDONLY);
+    if (fd < 0) {
+        close(ifd);
+        return 0;
+    }
+
+    if (fstat(ifd, &ist) < 0 || fstat(fd, &st) < 0)
+        goto error;
+
+    if ((size_t)st.st_size < sizeof(*hdr)) {
+        errno = ESTALE;
+        goto error;
+    }
+
+    inv->size = st.st_size;
+    inv->map  = mmap(NULL, inv->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (inv->map == MAP_FAILED) {
+        inv->map = NULL;
+        goto error;
+    }
+
+    hdr = inv->header = inv->map;
+
+    if (memcmp(hdr->magic, BEE_INVENTORY_MAGIC, sizeof(hdr->magic))
+        || hdr->version   != BEE_INVENTORY_VERSION
+        || hdr->byteorder != BEE_INVENTORY_BYTEORDER
+        || hdr->size      != inv->size
+        || hdr->inventory_size       != (uint64_t)ist.st_size
+        || hdr->inventory_mtime      != ist.st_mtim.tv_sec
+        || hdr->inventory_mtime_nsec != ist.st_mtim.tv_nsec
+        || hdr->inventory_ino        != ist.st_ino
+        || !hdr->nhash || (hdr->nhash & (hdr->nhash - 1))
+        || !check_table(inv, hdr->records, hdr->nrecords, sizeof(*inv->records))
+        || !check_table(inv, hdr->pkgs, hdr->npkgs, sizeof(*inv->pkgs))
+        || !check_table(inv, hdr->paths, hdr->npaths, sizeof(*inv->paths))
+        || !check_table(inv, hdr->owners, hdr->nrecords, sizeof(*inv->owners))
+        || !check_table(inv, hdr->hash, hdr->nhash, sizeof(*inv->hash))
+        || !hdr->nnodes
+        || !check_table(inv, hdr->nodes, hdr->nnodes, sizeof(*inv->nodes))
+        || !check_table(inv, hdr->pathnames, hdr->pathnamesize, 1)
+        || (hdr->pathnamesize
+            && ((char *)inv->map)[hdr->pathnames + hdr->pathnamesize - 1] != '\0')
+        || !check_table(inv, hdr->strings, 1, 1)
+        || ((char *)inv->map)[inv->size - 1] != '\0') {
+        errno = ESTALE;
+        goto error;
+    }
+
+    inv->textsize = ist.st_size;
+    if (inv->textsize) {
+        inv->text = mmap(NULL, inv->textsize, PROT_READ, MAP_SHARED, ifd, 0);
+        if (inv->text == MAP_FAILED) {
+            inv->text = NULL;
+            goto error;
+        }
+    }
+
+    close(fd);
+    close(ifd);
+
+    inv->records = (void *)((char *)inv->map + hdr->records);
+    inv->pkgs    = (void *)((char *)inv->map + hdr->pkgs);
+    inv->paths   = (void *)((char *)inv->map + hdr->paths);
+    inv->owners  = (void *)((char *)inv->map + hdr->owners);
+    inv->hash    = (void *)((char *)inv->map + hdr->hash);
+    inv->nodes   = (void *)((char *)inv->map + hdr->nodes);
+    inv->pathnames = (char *)inv->map + hdr->pathnames;
+    inv->strings = (char *)inv->map + hdr->strings;
+
+    return 1;
+
+error:
+    close(fd);
+    close(ifd);
+    bee_inventory_close(inv);
+
+    return 0;
+}
+
+void bee_inventory_close(struct bee_inventory *inv)
+{
+    int err = errno;
+
+    assert(inv);
+
+    if (inv->map)
+        munmap(inv->map, inv->size);
+
+    if (inv->text)
+        munmap(inv->text, inv->textsize);
+
+    memset(inv, 0, sizeof(*inv));
+
+    errno = err;
+}
+
+/* O(1): look path up in the hash table */
+struct bee_inventory_path *bee_inventory_find_path(struct bee_inventory *inv, const char *path)
+{
+    struct bee_inventory_path *p;
+    uint64_t mask, h;
+    uint32_t nr;
+    size_t len;
+
+    assert(inv);
+    assert(path);
+
+    mask = inv->header->nhash - 1;
+    len  = strlen(path);
+
+    for (h = hash_path(path) & mask; (nr = inv->hash[h]); h = (h + 1) & mask) {
+        p = &inv->paths[nr-1];
+        if (p->length == len && !memcmp(BEE_INVENTORY_TEXT(inv, p->name), path, len))
+            return p;
+    }
+
+    return NULL;
+}
+
+/* O(log n): binary search in the sorted package table */
+struct bee_inventory_pkg *bee_inventory_find_pkg(struct bee_inventory *inv, const char *pkg)
+{
+    uint64_t lo, hi, mid;
+    int cmp;
+
+    assert(inv);
+    assert(pkg);
+
+    lo = 0;
+    hi = inv->header->npkgs;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        cmp = strcmp(pkg, BEE_INVENTORY_STRING(inv, inv->pkgs[mid].name));
+
+        if (!cmp)
+            return &inv->pkgs[mid];
+
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return NULL;
+}
+
+/* compare the component s[0..len) with the first component of label */
+static int compare_label(struct bee_inventory *inv, struct bee_inventory_node *node,
+                         const char *s, uint32_t len)
+{
+    const char *l, *end;
+    uint32_t llen;
+    int cmp;
+
+    l    = BEE_INVENTORY_TEXT(inv, node->label);
+    end  = l + node->length;
+    llen = next_component(&l, end);
+
+    cmp = memcmp(s, l, len < llen ? len : llen);
+    if (cmp)
+        return cmp;
+
+    return len < llen ? -1 : (len > llen);
+}
+
+static int check_node(struct bee_inventory *inv, struct bee_inventory_node *node)
+{
+    return node->children <= inv->header->nnodes
+        && node->nchildren <= inv->header->nnodes - node->children
+        && node->label <= inv->textsize
+        && node->length <= inv->textsize - node->label
+        && node->path <= inv->header->npaths;
+}
+
+/*
+ * O(depth): walk the trie along the components of path
+ *
+ * RETURN: the node of path or, if path ends inside a merged label, the
+ *         node whose subtree is the one of path. NULL if nothing is at
+ *         or below path.
+ */
+struct bee_inventory_node *bee_inventory_find_node(struct bee_inventory *inv, const char *path)
+{
+    struct bee_inventory_node *node, *child;
+    const char *s, *end, *l, *lend;
+    uint32_t len, llen, lo, hi, mid;
+    int cmp;
+
+    assert(inv);
+    assert(path);
+
+    node = &inv->nodes[0];
+    s    = path;
+    end  = path + strlen(path);
+
+    while (1) {
+        if (!check_node(inv, node))
+            return NULL;
+
+        len = next_component(&s, end);
+        if (!len)
+            return node;
+
+        lo    = node->children;
+        hi    = node->children + node->nchildren;
+        child = NULL;
+
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (!check_node(inv, &inv->nodes[mid]))
+                return NULL;
+
+            cmp = compare_label(inv, &inv->nodes[mid], s, len);
+            if (!cmp) {
+                child = &inv->nodes[mid];
+                break;
+            }
+
+            if (cmp < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+
+        if (!child)
+            return NULL;
+
+        l    = BEE_INVENTORY_TEXT(inv, child->label);
+        lend = l + child->length;
+
+        while ((llen = next_component(&l, lend))) {
+            len = next_component(&s, end);
+            if (!len)
+                return child;
+
+            if (len != llen || memcmp(s, l, len))
+                return NULL;
+
+            s += len;
+            l += llen;
+        }
+
+        node = child;
+    }
+}
+
+/*
+ * collect the numbers of all packages owning node or anything below it
+ * in *pkgs, sorted like the package table. *pkgs must be freed.
+ *
+ * RETURN: 1 on success, 0 on error
+ */
+int bee_inventory_subtree_pkgs(struct bee_inventory *inv, struct bee_inventory_node *node,
+                               uint32_t **pkgs, size_t *npkgs)
+{
+    struct bee_inventory_path *path;
+    struct bee_inventory_node *n;
+    uint32_t *stack = NULL, *list;
+    size_t nstack = 0, stacksize = 64, i;
+    char *seen;
+    uint32_t c, pkg;
+    int res = 0;
+
+    assert(inv);
+    assert(node);
+    assert(pkgs);
+    assert(npkgs);
+
+    *pkgs  = NULL;
+    *npkgs = 0;
+
+    if (node->owner == BEE_INVENTORY_NOPKG)
+        return 1;
+
+    /* a single owner is known without walking the subtree */
+    if (node->owner != BEE_INVENTORY_MANYPKGS) {
+        *pkgs = malloc(sizeof(**pkgs));
+        if (!*pkgs) {
+            perror("malloc");
+            return 0;
+        }
+        **pkgs = node->owner;
+        *npkgs = 1;
+        return 1;
+    }
+
+    seen  = calloc(inv->header->npkgs ? inv->header->npkgs : 1, 1);
+    stack = malloc(stacksize * sizeof(*stack));
+    if (!seen || !stack) {
+        perror("calloc");
+        goto out;
+    }
+
+    stack[nstack++] = node - inv->nodes;
+
+    while (nstack) {
+        n = &inv->nodes[stack[--nstack]];
+        if (!check_node(inv, n))
+            continue;
+
+        if (n->owner != BEE_INVENTORY_MANYPKGS) {
+            if (n->owner < inv->header->npkgs)
+                seen[n->owner] = 1;
+            continue;
+        }
+
+        if (n->path) {
+            path = &inv->paths[n->path-1];
+            for (i = 0; i < path->count; i++) {
+                pkg = inv->records[inv->owners[path->first + i]].pkg;
+                if (pkg < inv->header->npkgs)
+                    seen[pkg] = 1;
+            }
+        }
+
+        for (c = 0; c < n->nchildren; c++) {
+            if (nstack == stacksize) {
+                stacksize *= 2;
+                list = realloc(stack, stacksize * sizeof(*stack));
+                if (!list) {
+                    perror("realloc");
+                    goto out;
+                }
+                stack = list;
+            }
+            stack[nstack++] = n->children + c;
+        }
+    }
+
+    for (i = 0; i < inv->header->npkgs; i++)
+        *npkgs += seen[i];
+
+    *pkgs = malloc((*npkgs ? *npkgs : 1) * sizeof(**pkgs));
+    if (!*pkgs) {
+        perror("malloc");
+        *npkgs = 0;
+        goto out;
+    }
+
+    for (i = 0, c = 0; i < inv->header->npkgs; i++) {
+        if (seen[i])
+            (*pkgs)[c++] = i;
+    }
+
+    res = 1;
+
+out:
+    free(stack);
+    free(seen);
+
+    return res;
+}
+
+/*
+ * O(depth): is path or anything below it owned by a package other than pkg?
+ */
+int bee_inventory_owned_by_other(struct bee_inventory *inv, const char *path, const char *pkg)
+{
+    struct bee_inventory_node *node;
+
+    assert(inv);
+    assert(path);
+    assert(pkg);
+
+    node = bee_inventory_find_node(inv, path);
+    if (!node || node->owner == BEE_INVENTORY_NOPKG)
+        return 0;
+
+    if (node->owner == BEE_INVENTORY_MANYPKGS)
+        return 1;
+
+    if (node->owner >= inv->header->npkgs)
+        return 0;
+
+    return strcmp(BEE_INVENTORY_STRING(inv, inv->pkgs[node->owner].name), pkg) != 0;
+}
+
+/* number of the path whose name in pathnames covers offset off */
+static uint64_t pathname_at(struct bee_inventory *inv, uint64_t off)
+{
+    uint64_t lo, hi, mid;
+
+    lo = 0;
+    hi = inv->header->npaths;
+
+    while (hi - lo > 1) {
+        mid = lo + (hi - lo) / 2;
+
+        if (inv->paths[mid].pathname <= off)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/*
+ * find the longest string every match of the extended regex re contains.
+ * patterns with alternatives, groups, brackets, intervals or escapes are
+ * not looked at.
+ *
+ * RETURN: length of the string at *lit or 0 if there is none
+ */
+static size_t regex_literal(const char *re, const char **lit)
+{
+    const char *s, *start = re;
+    size_t len = 0, best = 0;
+
+    *lit = re;
+
+    if (strpbrk(re, "|()[]{}\\"))
+        return 0;
+
+    for (s = re; ; s++) {
+        if (*s && !strchr(".*+?^$", *s)) {
+            if (!len)
+                start = s;
+            len++;
+            continue;
+        }
+
+        /* the character before these may be missing */
+        if (len && (*s == '*' || *s == '?'))
+            len--;
+
+        if (len > best) {
+            best = len;
+            *lit  = start;
+        }
+
+        len = 0;
+
+        if (!*s)
+            break;
+    }
+
+    return best;
+}
+
+/*
+ * one scan of pathnames: collect the numbers of all paths containing
+ * pattern or, with BEE_INVENTORY_MATCH_REGEX, matching the extended regex
+ * pattern in *paths, sorted like the path table. a string every match of
+ * the regex must contain is searched first so regexec() only sees paths
+ * that may match. *paths must be freed.
+ *
+ * RETURN: 1 on success, 0 on error
+ */
+int bee_inventory_match_paths(struct bee_inventory *inv, const char *pattern, int flags,
+                              uint32_t **paths, size_t *npaths)
+{
+    struct bee_inventory_path *path;
+    const char *lit, *s, *end, *hit, *name;
+    uint32_t *list;
+    uint64_t nr, next = 0;
+    size_t litlen, alloc = 0;
+    char msg[256];
+    regex_t re;
+    int err, res = 0;
+
+    assert(inv);
+    assert(pattern);
+    assert(paths);
+    assert(npaths);
+
+    *paths  = NULL;
+    *npaths = 0;
+
+    if (flags & BEE_INVENTORY_MATCH_REGEX) {
+        err = regcomp(&re, pattern, REG_EXTENDED|REG_NOSUB);
+        if (err) {
+            regerror(err, &re, msg, sizeof(msg));
+            fprintf(stderr, "bee-inventory: %s: %s\n", pattern, msg);
+            return 0;
+        }
+        litlen = regex_literal(pattern, &lit);
+    } else {
+        lit    = pattern;
+        litlen = strlen(pattern);
+    }
+
+    s   = inv->pathnames;
+    end = inv->pathnames + inv->header->pathnamesize;
+
+    while (s < end && next < inv->header->npaths) {
+        if (litlen) {
+            hit = memmem(s, end - s, lit, litlen);
+            if (!hit)
+                break;
+            nr = pathname_at(inv, hit - inv->pathnames);
+        } else {
+            nr = next;
+        }
+
+        path = &inv->paths[nr];
+        if (path->pathname >= inv->header->pathnamesize
+            || path->length >= inv->header->pathnamesize - path->pathname)
+            break;
+
+        name = inv->pathnames + path->pathname;
+        s    = name + path->length + 1;
+        next = nr + 1;
+
+        if ((flags & BEE_INVENTORY_MATCH_REGEX) && regexec(&re, name, 0, NULL, 0))
+            continue;
+
+        if (*npaths == alloc) {
+            alloc = alloc ? alloc * 2 : 64;
+            list  = realloc(*paths, alloc * sizeof(**paths));
+            if (!list) {
+                perror("realloc");
+                free(*paths);
+                *paths  = NULL;
+                *npaths = 0;
+                goto out;
+            }
+            *paths = list;
+        }
+
+        (*paths)[(*npaths)++] = nr;
+    }
+
+    res = 1;
+
+out:
+    if (flags & BEE_INVENTORY_MATCH_REGEX)
+        regfree(&re);
+
+    return res;
+}
@@ -0,0 +1,173 @@
+/*
+** bee_inventory - memory mapped binary index of bee's INVENTORY
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_INVENTORY_H
+#define BEE_INVENTORY_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * layout of <inventory>.idx (host byte order, every table 8 byte aligned):
+ *
+ *   header
+ *   records[nrecords]   one per inventory line, grouped by package and
+ *                       in inventory order inside a package
+ *   pkgs[npkgs]         sorted by name, range of records of the package
+ *   paths[npaths]       sorted by path, range of owners of the path
+ *   owners[nrecords]    record numbers grouped by path in inventory order
+ *   hash[nhash]         open addressing table of path numbers + 1
+ *   nodes[nnodes]       radix trie of the path components, see below
+ *   pathnames           NUL terminated paths in the order of paths
+ *   strings             NUL terminated package names
+ *
+ * lines and paths are offset/length pairs into the text inventory which
+ * is mapped next to the index. the path of a line is everything after
+ * its 7th space like 'cut -d" " -f8-'. package names are offsets into
+ * strings.
+ *
+ * pathnames holds every path once more, back to back, so matching all
+ * paths against a pattern is one scan of a single compact table instead
+ * of the whole inventory.
+ *
+ * the trie is compressed: a node without a path of its own and with a
+ * single child is merged with it, so a label is one or more components
+ * of a path in the text inventory. nodes[0] is "/", the children of a
+ * node follow each other and are sorted by their first component. each
+ * node knows the only package owning it or anything below it so asking
+ * whether a directory is owned by someone else does not need to visit
+ * the subtree.
+ */
+
+#define BEE_INVENTORY_MAGIC     "BEEINVIX"
+#define BEE_INVENTORY_VERSION   4
+#define BEE_INVENTORY_BYTEORDER 0x01020304
+
+struct bee_inventory_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+
+    /* stat of the indexed inventory to detect a stale index */
+    uint64_t inventory_size;
+    int64_t  inventory_mtime;
+    int64_t  inventory_mtime_nsec;
+    uint64_t inventory_ino;
+
+    uint64_t nrecords;
+    uint64_t npkgs;
+    uint64_t npaths;
+    uint64_t nhash;
+    uint64_t nnodes;
+    uint64_t pathnamesize;
+
+    uint64_t records;
+    uint64_t pkgs;
+    uint64_t paths;
+    uint64_t owners;
+    uint64_t hash;
+    uint64_t nodes;
+    uint64_t pathnames;
+    uint64_t strings;
+    uint64_t size;
+};
+
+struct bee_inventory_record {
+    uint64_t line;
+    uint32_t length;
+    uint32_t pkg;
+    uint32_t path;
+    uint32_t reserved;
+};
+
+struct bee_inventory_pkg {
+    uint64_t name;
+    uint32_t first;
+    uint32_t count;
+};
+
+struct bee_inventory_path {
+    uint64_t name;
+    uint32_t length;
+    uint32_t first;
+    uint32_t count;
+    uint32_t pathname;  /* offset into pathnames */
+};
+
+/* owner of a node owned by nobody or by more than one package */
+#define BEE_INVENTORY_NOPKG    UINT32_MAX
+#define BEE_INVENTORY_MANYPKGS (UINT32_MAX - 1)
+
+struct bee_inventory_node {
+    uint64_t label;
+    uint32_t length;
+    uint32_t path;      /* path number + 1 or 0 */
+    uint32_t children;
+    uint32_t nchildren;
+    uint32_t owner;     /* package number, NOPKG or MANYPKGS */
+    uint32_t reserved;
+};
+
+struct bee_inventory {
+    void   *map;
+    size_t size;
+
+    char   *text;
+    size_t textsize;
+
+    struct bee_inventory_header *header;
+    struct bee_inventory_record *records;
+    struct bee_inventory_pkg    *pkgs;
+    struct bee_inventory_path   *paths;
+    uint32_t                    *owners;
+    uint32_t                    *hash;
+    struct bee_inventory_node   *nodes;
+    char                        *pathnames;
+    char                        *strings;
+};
+
+#define BEE_INVENTORY_STRING(inv, off)  ((inv)->strings + (off))
+#define BEE_INVENTORY_TEXT(inv, off)    ((inv)->text + (off))
+
+/* flags of bee_inventory_match_paths() */
+#define BEE_INVENTORY_MATCH_STRING 0
+#define BEE_INVENTORY_MATCH_REGEX  1
+
+int bee_inventory_index_write(char *inventory, char *index, int flags);
+
+int  bee_inventory_open(struct bee_inventory *inv, char *inventory, char *index);
+void bee_inventory_close(struct bee_inventory *inv);
+
+struct bee_inventory_path *bee_inventory_find_path(struct bee_inventory *inv, const char *path);
+struct bee_inventory_pkg  *bee_inventory_find_pkg(struct bee_inventory *inv, const char *pkg);
+struct bee_inventory_node *bee_inventory_find_node(struct bee_inventory *inv, const char *path);
+
+int bee_inventory_subtree_pkgs(struct bee_inventory *inv, struct bee_inventory_node *node,
+                               uint32_t **pkgs, size_t *npkgs);
+int bee_inventory_owned_by_other(struct bee_inventory *inv, const char *path, const char *pkg);
+
+int bee_inventory_match_paths(struct bee_inventory *inv, const char *pattern, int flags,
+                              uint32_t **paths, size_t *npaths);
+
+#endif
@@ -0,0 +1,282 @@
+/*
+** bee_manifest - state of the packages a bee-cache INVENTORY was built from
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "bee_manifest.h"
+#include "bee_output.h"
+
+void bee_manifest_stat(struct bee_manifest_stat *ms, struct stat *st)
+{
+    assert(ms);
+    assert(st);
+
+    ms->ino        = st->st_ino;
+    ms->size       = st->st_size;
+    ms->mtime      = st->st_mtim.tv_sec;
+    ms->mtime_nsec = st->st_mtim.tv_nsec;
+}
+
+int bee_manifest_stat_equal(struct bee_manifest_stat *a, struct bee_manifest_stat *b)
+{
+    assert(a);
+    assert(b);
+
+    return a->ino   == b->ino   && a->size       == b->size &&
+           a->mtime == b->mtime && a->mtime_nsec == b->mtime_nsec;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+    const struct bee_manifest_entry *x = a, *y = b;
+
+    return strcmp(x->pkg, y->pkg);
+}
+
+static int parse_stat(char *s, struct bee_manifest_stat *ms, int *n)
+{
+    return sscanf(s, "%" SCNu64 " %" SCNu64 " %" SCNd64 ".%" SCNd64 "%n",
+                  &ms->ino, &ms->size, &ms->mtime, &ms->mtime_nsec, n) == 4;
+}
+
+static int parse_entry(char *line, struct bee_manifest_entry *e)
+{
+    char *s;
+    int n;
+
+    s = strchr(line, ' ');
+    if (!s || s == line)
+        return 0;
+
+    *(s++) = '\0';
+
+    if (!parse_stat(s, &e->content, &n))
+        return 0;
+
+    s += n;
+
+    if (!strcmp(s, " -")) {
+        e->has_checksum = 0;
+    } else if (sscanf(s, " %" SCNx64 "%n", &e->checksum, &n) == 1 && !s[n]) {
+        e->has_checksum = 1;
+    } else {
+        return 0;
+    }
+
+    e->pkg = strdup(line);
+
+    return e->pkg != NULL;
+}
+
+/*
+ * RETURN: 1 on success
+ *         0 on error; errno is ENOENT if there is no manifest and
+ *           EINVAL if it can't be parsed
+ */
+int bee_manifest_read(struct bee_manifest *m, char *file)
+{
+    struct bee_manifest_entry *entries;
+    FILE *fh;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    size_t alloc = 0;
+    unsigned long lineno = 0;
+    int version, n;
+    int res = 1;
+
+    assert(m);
+    assert(file);
+
+    memset(m, 0, sizeof(*m));
+
+    fh = fopen(file, "r");
+    if (!fh)
+        return 0;
+
+    while ((len = getline(&line, &size, fh)) > 0) {
+        if (line[len-1] == '\n')
+            line[--len] = '\0';
+
+        lineno++;
+
+        if (lineno == 1) {
+            if (sscanf(line, BEE_MANIFEST_MAGIC " %d%n", &version, &n) != 1
+                || line[n] || version != BEE_MANIFEST_VERSION)
+                break;
+            continue;
+        }
+
+        if (lineno == 2) {
+            if (strncmp(line, "INVENTORY ", 10)
+                || !parse_stat(line + 10, &m->inventory, &n) || line[10 + n])
+                break;
+            continue;
+        }
+
+        if (m->nentries == alloc) {
+            alloc = alloc ? alloc * 2 : 1024;
+            entries = realloc(m->entries, alloc * sizeof(*entries));
+            if (!entries) {
+                res = 0;
+                goto out;
+            }
+            m->entries = entries;
+        }
+
+        if (!parse_entry(line, &m->entries[m->nentries]))
+            break;
+
+        m->nentries++;
+    }
+
+    if (ferror(fh)) {
+        res = 0;
+    } else if (!feof(fh) || lineno < 2) {
+        errno = EINVAL;
+        res = 0;
+    }
+
+    qsort(m->entries, m->nentries, sizeof(*m->entries), compare_entries);
+
+out:
+    free(line);
+    fclose(fh);
+
+    if (!res) {
+        n = errno;
+        bee_manifest_free(m);
+        errno = n;
+    }
+
+    return res;
+}
+
+/* replace <file> through bee_output with flags */
+int bee_manifest_write(struct bee_manifest *m, char *file, int flags)
+{
+    struct bee_manifest_entry *e;
+    struct bee_output out;
+    FILE *fh;
+    size_t i;
+
+    assert(m);
+    assert(file);
+
+    fh = bee_output_open(&out, file, flags);
+    if (!fh)
+        return 0;
+
+    fprintf(fh, "%s %d\n", BEE_MANIFEST_MAGIC, BEE_MANIFEST_VERSION);
+    fprintf(fh, "INVENTORY %" PRIu64 " %" PRIu64 " %" PRId64 ".%09" PRId64 "\n",
+            m->inventory.ino, m->inventory.size,
+            m->inventory.mtime, m->inventory.mtime_nsec);
+
+    for (i = 0; i < m->nentries; i++) {
+        e = &m->entries[i];
+
+        fprintf(fh, "%s %" PRIu64 " %" PRIu64 " %" PRId64 ".%09" PRId64,
+                e->pkg, e->content.ino, e->content.size,
+                e->content.mtime, e->content.mtime_nsec);
+
+        if (e->has_checksum)
+            fprintf(fh, " %016" PRIx64 "\n", e->checksum);
+        else
+            fputs(" -\n", fh);
+    }
+
+    if (ferror(fh)) {
+        bee_output_abort(&out);
+        return 0;
+    }
+
+    return bee_output_commit(&out);
+}
+
+void bee_manifest_free(struct bee_manifest *m)
+{
+    size_t i;
+
+    assert(m);
+
+    for (i = 0; i < m->nentries; i++)
+        free(m->entries[i].pkg);
+
+    free(m->entries);
+
+    m->entries  = NULL;
+    m->nentries = 0;
+}
+
+struct bee_manifest_entry *bee_manifest_find(struct bee_manifest *m, const char *pkg)
+{
+    struct bee_manifest_entry key;
+
+    assert(m);
+    assert(pkg);
+
+    key.pkg = (char *)pkg;
+
+    return bsearch(&key, m->entries, m->nentries, sizeof(key), compare_entries);
+}
+
+/* FNV-1a over the contents of file */
+int bee_manifest_checksum(char *file, uint64_t *checksum)
+{
+    unsigned char buf[65536];
+    uint64_t h = 14695981039346656037ULL;
+    FILE *fh;
+    size_t n, i;
+    int res;
+
+    assert(file);
+    assert(checksum);
+
+    fh = fopen(file, "r");
+    if (!fh)
+        return 0;
+
+    while ((n = fread(buf, 1, sizeof(buf), fh)) > 0) {
+        for (i = 0; i < n; i++) {
+            h ^= buf[i];
+            h *= 1099511628211ULL;
+        }
+    }
+
+    res = !ferror(fh);
+
+    fclose(fh);
+
+    *checksum = h;
+
+    return res;
+}
@@ -0,0 +1,79 @@
+/*
+** bee_manifest - state of the packages a bee-cache INVENTORY was built from
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_MANIFEST_H
+#define BEE_MANIFEST_H 1
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+/*
+ * the manifest is a text file next to the INVENTORY:
+ *
+ *   BEE-CACHE-MANIFEST 1
+ *   INVENTORY <ino> <size> <mtime>.<nsec>
+ *   <pkg> <ino> <size> <mtime>.<nsec> <checksum>
+ *   ...
+ *
+ * the second line is the stat of the INVENTORY as it was written, the
+ * others the stat of <metadir>/<pkg>/CONTENT as it was inventoried and
+ * the FNV-1a checksum of <pkg>.bc in hex or '-' if there was none.
+ * packages are sorted by name.
+ */
+
+#define BEE_MANIFEST_MAGIC   "BEE-CACHE-MANIFEST"
+#define BEE_MANIFEST_VERSION 1
+
+struct bee_manifest_stat {
+    uint64_t ino;
+    uint64_t size;
+    int64_t  mtime;
+    int64_t  mtime_nsec;
+};
+
+struct bee_manifest_entry {
+    char                     *pkg;
+    struct bee_manifest_stat content;
+    uint64_t                 checksum;
+    int                      has_checksum;
+};
+
+struct bee_manifest {
+    struct bee_manifest_stat  inventory;
+    struct bee_manifest_entry *entries;
+    size_t                    nentries;
+};
+
+void bee_manifest_stat(struct bee_manifest_stat *ms, struct stat *st);
+int  bee_manifest_stat_equal(struct bee_manifest_stat *a, struct bee_manifest_stat *b);
+
+int  bee_manifest_read(struct bee_manifest *m, char *file);
+int  bee_manifest_write(struct bee_manifest *m, char *file, int flags);
+void bee_manifest_free(struct bee_manifest *m);
+
+struct bee_manifest_entry *bee_manifest_find(struct bee_manifest *m, const char *pkg);
+
+int  bee_manifest_checksum(char *file, uint64_t *checksum);
+
+#endif
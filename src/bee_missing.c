@@ -0,0 +1,477 @@
+/*
+** bee_missing - find the files of an inventory that don't exist
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bee_missing.h"
+#include "bee_sort.h"
+
+/*
+ * missing files
+ *
+ * lines written to the stream returned by bee_missing_open() are
+ * cut into batches whose files are checked by a pool of workers. each
+ * batch is grouped by parent directory so every directory is opened once
+ * and its entries are checked with fstatat() relative to it. like
+ * '[ -e <file> ]' symbolic links are followed. the lines of missing files
+ * are written to the underlying output in input order.
+ */
+
+#define MISSING_BATCH (1024 * 1024)
+
+struct missing_file {
+    char   *line;
+    char   *dir;
+    size_t dirlen;
+    char   *name;
+    int    missing;
+};
+
+struct missing_batch {
+    char   *buf;
+    size_t len;
+    char   *out;
+    size_t outlen;
+    int    done;
+    int    res;
+};
+
+struct bee_missing {
+    FILE   *out;
+    char   *pkg;
+    size_t pkglen;
+
+    /* data after the last complete line */
+    char   *buf;
+    size_t len;
+    size_t size;
+
+    /* ring of batches: stitched < head <= next <= tail, taken < next */
+    struct missing_batch *batches;
+    size_t nbatches;
+    size_t head;
+    size_t next;
+    size_t tail;
+
+    pthread_t *threads;
+    long nthreads;
+    pthread_mutex_t lock;
+    pthread_cond_t  work;
+    pthread_cond_t  done;
+    int stop;
+
+    int failed;
+};
+
+static int compare_missing_dirs(const void *a, const void *b)
+{
+    const struct missing_file *x = *(struct missing_file **)a;
+    const struct missing_file *y = *(struct missing_file **)b;
+    int cmp;
+
+    cmp = memcmp(x->dir, y->dir, x->dirlen < y->dirlen ? x->dirlen : y->dirlen);
+    if (cmp)
+        return cmp;
+    if (x->dirlen != y->dirlen)
+        return x->dirlen < y->dirlen ? -1 : 1;
+
+    return 0;
+}
+
+/* check the files of b->buf and collect the lines of missing ones in b->out */
+static int missing_check(struct bee_missing *m, struct missing_batch *b)
+{
+    struct missing_file *files = NULL, **sorted = NULL, *f;
+    size_t nfiles = 0, i, j, len;
+    char *p, *end, *nl, *path, *slash, *dir;
+    struct stat st;
+    int fd;
+
+    for (p = b->buf, end = b->buf + b->len; p < end; p = nl + 1) {
+        nl = memchr(p, '\n', end - p);
+        if (!nl)
+            break;
+        nfiles++;
+    }
+
+    files  = malloc((nfiles ? nfiles : 1) * sizeof(*files));
+    sorted = malloc((nfiles ? nfiles : 1) * sizeof(*sorted));
+    b->out = malloc(b->len ? b->len : 1);
+    if (!files || !sorted || !b->out) {
+        perror("malloc");
+        free(files);
+        free(sorted);
+        return 0;
+    }
+
+    nfiles = 0;
+
+    for (p = b->buf; p < end; p = nl + 1) {
+        nl = memchr(p, '\n', end - p);
+        if (!nl)
+            break;
+        *nl = '\0';
+
+        if (m->pkg && (strncmp(p, m->pkg, m->pkglen) || p[m->pkglen] != ' '))
+            continue;
+
+        f = &files[nfiles];
+        f->line    = p;
+        f->missing = 0;
+
+        path  = bee_sort_key(p) + 1;
+        slash = strrchr(path, '/');
+        if (slash && slash[1]) {
+            f->dir    = path;
+            f->dirlen = (slash == path) ? 1 : slash - path;
+            f->name   = slash + 1;
+        } else {
+            f->dir    = NULL;
+            f->dirlen = 0;
+            f->name   = path;
+        }
+
+        sorted[nfiles] = f;
+        nfiles++;
+    }
+
+    qsort(sorted, nfiles, sizeof(*sorted), compare_missing_dirs);
+
+    for (i = 0; i < nfiles; i = j) {
+        f = sorted[i];
+
+        for (j = i + 1; j < nfiles && !compare_missing_dirs(&sorted[i], &sorted[j]); j++)
+            ;
+
+        /* unusual paths like "/" are checked as they are */
+        if (!f->dir) {
+            for (; i < j; i++)
+                sorted[i]->missing = (stat(sorted[i]->name, &st) < 0);
+            continue;
+        }
+
+        dir = strndup(f->dir, f->dirlen);
+        if (!dir) {
+            perror("strndup");
+            free(files);
+            free(sorted);
+            return 0;
+        }
+
+        fd = open(dir, O_PATH|O_DIRECTORY|O_CLOEXEC);
+        free(dir);
+
+        for (; i < j; i++)
+            sorted[i]->missing = (fd < 0 || fstatat(fd, sorted[i]->name, &st, 0) < 0);
+
+        if (fd >= 0)
+            close(fd);
+    }
+
+    b->outlen = 0;
+
+    for (i = 0; i < nfiles; i++) {
+        if (!files[i].missing)
+            continue;
+
+        len = strlen(files[i].line);
+        memcpy(b->out + b->outlen, files[i].line, len);
+        b->out[b->outlen + len] = '\n';
+        b->outlen += len + 1;
+    }
+
+    free(files);
+    free(sorted);
+
+    return 1;
+}
+
+static void *missing_worker(void *arg)
+{
+    struct bee_missing *m = arg;
+    struct missing_batch *b;
+    int res;
+
+    pthread_mutex_lock(&m->lock);
+
+    while (1) {
+        while (!m->stop && m->next == m->tail)
+            pthread_cond_wait(&m->work, &m->lock);
+
+        if (m->next == m->tail)
+            break;
+
+        b = &m->batches[m->next++ % m->nbatches];
+        pthread_mutex_unlock(&m->lock);
+
+        res = missing_check(m, b);
+
+        pthread_mutex_lock(&m->lock);
+        b->res  = res;
+        b->done = 1;
+        pthread_cond_broadcast(&m->done);
+    }
+
+    pthread_mutex_unlock(&m->lock);
+
+    return NULL;
+}
+
+static int missing_write_batch(struct bee_missing *m, struct missing_batch *b)
+{
+    int res = b->res;
+
+    if (res && b->outlen && fwrite(b->out, b->outlen, 1, m->out) != 1) {
+        perror("bee-missing: writing missing files failed");
+        res = 0;
+    }
+
+    free(b->buf);
+    free(b->out);
+    memset(b, 0, sizeof(*b));
+
+    return res;
+}
+
+/* write the oldest batch once it is checked, called with m->lock held */
+static int missing_stitch(struct bee_missing *m)
+{
+    struct missing_batch *b = &m->batches[m->head % m->nbatches];
+    int res;
+
+    while (!b->done)
+        pthread_cond_wait(&m->done, &m->lock);
+
+    pthread_mutex_unlock(&m->lock);
+    res = missing_write_batch(m, b);
+    pthread_mutex_lock(&m->lock);
+
+    m->head++;
+
+    return res;
+}
+
+/* hand the first len bytes of m->buf to a worker or check them here */
+static int missing_submit(struct bee_missing *m, size_t len)
+{
+    struct missing_batch *b, batch;
+    int res = 1;
+
+    memset(&batch, 0, sizeof(batch));
+
+    batch.len = len;
+    batch.buf = malloc(len ? len : 1);
+    if (!batch.buf) {
+        perror("malloc");
+        return 0;
+    }
+
+    memcpy(batch.buf, m->buf, len);
+    memmove(m->buf, m->buf + len, m->len - len);
+    m->len -= len;
+
+    if (!m->nthreads) {
+        batch.res = missing_check(m, &batch);
+        return missing_write_batch(m, &batch);
+    }
+
+    pthread_mutex_lock(&m->lock);
+
+    while (res && m->tail - m->head == m->nbatches)
+        res = missing_stitch(m);
+
+    if (res) {
+        b  = &m->batches[m->tail++ % m->nbatches];
+        *b = batch;
+        pthread_cond_signal(&m->work);
+    } else {
+        free(batch.buf);
+    }
+
+    pthread_mutex_unlock(&m->lock);
+
+    return res;
+}
+
+static ssize_t missing_write(void *cookie, const char *data, size_t size)
+{
+    struct bee_missing *m = cookie;
+    size_t nsize;
+    char *buf, *nl;
+
+    if (m->failed)
+        return -1;
+
+    if (m->len + size > m->size) {
+        nsize = m->size ? m->size : MISSING_BATCH;
+        while (nsize < m->len + size)
+            nsize *= 2;
+
+        buf = realloc(m->buf, nsize);
+        if (!buf) {
+            perror("realloc");
+            m->failed = 1;
+            return -1;
+        }
+        m->buf  = buf;
+        m->size = nsize;
+    }
+
+    memcpy(m->buf + m->len, data, size);
+    m->len += size;
+
+    if (m->len >= MISSING_BATCH) {
+        nl = memrchr(m->buf, '\n', m->len);
+        if (nl && !missing_submit(m, nl - m->buf + 1)) {
+            m->failed = 1;
+            return -1;
+        }
+    }
+
+    return size;
+}
+
+static int missing_close(void *cookie)
+{
+    struct bee_missing *m = cookie;
+    int res = !m->failed;
+    long i;
+
+    if (res && m->len && m->buf[m->len-1] != '\n')
+        res = (missing_write(m, "\n", 1) == 1);
+
+    if (res && m->len)
+        res = missing_submit(m, m->len);
+
+    if (m->nthreads) {
+        pthread_mutex_lock(&m->lock);
+
+        while (m->head != m->tail) {
+            if (!missing_stitch(m))
+                res = 0;
+        }
+
+        m->stop = 1;
+        pthread_cond_broadcast(&m->work);
+        pthread_mutex_unlock(&m->lock);
+
+        for (i = 0; i < m->nthreads; i++)
+            pthread_join(m->threads[i], NULL);
+
+        pthread_cond_destroy(&m->done);
+        pthread_cond_destroy(&m->work);
+        pthread_mutex_destroy(&m->lock);
+    }
+
+    free(m->threads);
+    free(m->batches);
+    free(m->buf);
+    free(m);
+
+    return res ? 0 : EOF;
+}
+
+/*
+ * RETURN: stream to write a merged inventory to, the lines of files
+ *         that do not exist are written to out using jobs threads (or
+ *         none for jobs <= 1) and fclose() returns EOF if anything failed.
+ *         with pkg only files of pkg are checked.
+ */
+FILE *bee_missing_open(FILE *out, char *pkg, long jobs)
+{
+    struct bee_missing *m;
+    cookie_io_functions_t io = {
+        .write = missing_write,
+        .close = missing_close,
+    };
+    FILE *fh;
+    long i;
+
+    assert(out);
+
+    m = calloc(1, sizeof(*m));
+    if (!m) {
+        perror("calloc");
+        return NULL;
+    }
+
+    m->out = out;
+
+    if (pkg) {
+        m->pkg    = pkg;
+        m->pkglen = strlen(pkg);
+    }
+
+    if (jobs > 1) {
+        m->nbatches = 2 * jobs;
+        m->batches  = calloc(m->nbatches, sizeof(*m->batches));
+        m->threads  = calloc(jobs, sizeof(*m->threads));
+        if (!m->batches || !m->threads) {
+            perror("calloc");
+            free(m->batches);
+            free(m->threads);
+            free(m);
+            return NULL;
+        }
+
+        pthread_mutex_init(&m->lock, NULL);
+        pthread_cond_init(&m->work, NULL);
+        pthread_cond_init(&m->done, NULL);
+
+        for (i = 0; i < jobs; i++) {
+            errno = pthread_create(&m->threads[i], NULL, missing_worker, m);
+            if (errno) {
+                perror("pthread_create");
+                break;
+            }
+        }
+
+        /* with no worker at all the batches are checked in place */
+        m->nthreads = i;
+        if (!m->nthreads) {
+            pthread_cond_destroy(&m->done);
+            pthread_cond_destroy(&m->work);
+            pthread_mutex_destroy(&m->lock);
+        }
+    }
+
+    fh = fopencookie(m, "w", io);
+    if (!fh) {
+        perror("fopencookie");
+        m->failed = 1;
+        missing_close(m);
+    }
+
+    return fh;
+}
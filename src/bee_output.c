@@ -0,0 +1,278 @@
+/*
+** bee_output - replace output files atomically and optionally durably
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bee_output.h"
+
+static struct bee_output_stats stats;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* account t - *start to *counter and restart the clock */
+static void account(uint64_t *counter, uint64_t *start)
+{
+    uint64_t t = now_ns();
+
+    __atomic_add_fetch(counter, t - *start, __ATOMIC_RELAXED);
+    *start = t;
+}
+
+/* directory of name or "." */
+static char *dirname_of(char *name)
+{
+    char *dir, *slash;
+
+    slash = strrchr(name, '/');
+    if (!slash)
+        return strdup(".");
+
+    if (slash == name)
+        return strdup("/");
+
+    dir = strndup(name, slash - name);
+
+    return dir;
+}
+
+static int sync_dir(char *name)
+{
+    char *dir;
+    int fd, res;
+
+    dir = dirname_of(name);
+    if (!dir)
+        return 0;
+
+    fd = open(dir, O_RDONLY|O_DIRECTORY);
+    free(dir);
+    if (fd < 0)
+        return 0;
+
+    res = (fsync(fd) == 0);
+
+    close(fd);
+
+    return res;
+}
+
+/* give the O_TMPFILE a name */
+static int link_tmpfile(struct bee_output *out)
+{
+    char proc[64];
+    int res, retry;
+
+    snprintf(proc, sizeof(proc), "/proc/self/fd/%d", out->fd);
+
+    for (retry = 0; retry < 2; retry++) {
+        res = linkat(AT_FDCWD, proc, AT_FDCWD, out->tmpname, AT_SYMLINK_FOLLOW);
+
+        /* without /proc this needs CAP_DAC_READ_SEARCH */
+        if (res < 0 && errno == ENOENT)
+            res = linkat(out->fd, "", AT_FDCWD, out->tmpname, AT_EMPTY_PATH);
+
+        /* left over by a crashed process with our pid */
+        if (res < 0 && errno == EEXIST && !retry) {
+            unlink(out->tmpname);
+            continue;
+        }
+
+        break;
+    }
+
+    return res == 0;
+}
+
+static void output_free(struct bee_output *out)
+{
+    free(out->name);
+    free(out->tmpname);
+
+    out->name    = NULL;
+    out->tmpname = NULL;
+    out->fh      = NULL;
+    out->fd      = -1;
+}
+
+FILE *bee_output_open(struct bee_output *out, char *name, int flags)
+{
+    char *dir;
+    int err;
+
+    assert(out);
+    assert(name);
+
+    memset(out, 0, sizeof(*out));
+
+    out->fd    = -1;
+    out->flags = flags;
+    out->name  = strdup(name);
+
+    if (!out->name || asprintf(&out->tmpname, "%s.%d", name, getpid()) < 0) {
+        out->tmpname = NULL;
+        goto error;
+    }
+
+    if (flags & BEE_OUTPUT_TMPFILE) {
+        dir = dirname_of(name);
+        if (!dir)
+            goto error;
+
+        /* falls back to a named temporary file where unsupported */
+        out->fd = open(dir, O_TMPFILE|O_WRONLY, 0666);
+        out->tmpfile = (out->fd >= 0);
+
+        free(dir);
+    }
+
+    if (out->fd < 0)
+        out->fd = open(out->tmpname, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+
+    if (out->fd < 0)
+        goto error;
+
+    out->fh = fdopen(out->fd, "w");
+    if (!out->fh) {
+        err = errno;
+        close(out->fd);
+        if (!out->tmpfile)
+            unlink(out->tmpname);
+        errno = err;
+        goto error;
+    }
+
+    return out->fh;
+
+error:
+    err = errno;
+    output_free(out);
+    errno = err;
+
+    return NULL;
+}
+
+/*
+ * flush, close and move the output to its name
+ *
+ * RETURN: 1 on success
+ *         0 on error; the temporary file is removed and errno is set
+ */
+int bee_output_commit(struct bee_output *out)
+{
+    uint64_t t;
+    int named = !out->tmpfile;
+    int res, err;
+
+    assert(out);
+    assert(out->fh);
+
+    t = now_ns();
+
+    res = (fflush(out->fh) == 0);
+    account(&stats.flush_ns, &t);
+
+    if (res && (out->flags & BEE_OUTPUT_SYNC)) {
+        res = (fdatasync(out->fd) == 0);
+        account(&stats.datasync_ns, &t);
+    }
+
+    if (res && out->tmpfile)
+        named = res = link_tmpfile(out);
+
+    err = errno;
+    if (fclose(out->fh) == EOF && res) {
+        res = 0;
+        err = errno;
+    }
+
+    if (res) {
+        res = (rename(out->tmpname, out->name) == 0);
+        err = errno;
+        if (res)
+            named = 0;
+        account(&stats.rename_ns, &t);
+    }
+
+    if (res && (out->flags & BEE_OUTPUT_SYNC)) {
+        res = sync_dir(out->name);
+        err = errno;
+        account(&stats.dirsync_ns, &t);
+    }
+
+    if (named)
+        unlink(out->tmpname);
+
+    __atomic_add_fetch(&stats.files, 1, __ATOMIC_RELAXED);
+
+    output_free(out);
+
+    errno = err;
+
+    return res;
+}
+
+/* close and remove the output without touching <name> */
+void bee_output_abort(struct bee_output *out)
+{
+    int err = errno;
+
+    assert(out);
+
+    if (out->fh)
+        fclose(out->fh);
+
+    if (out->tmpname && !out->tmpfile)
+        unlink(out->tmpname);
+
+    output_free(out);
+
+    errno = err;
+}
+
+void bee_output_stats(struct bee_output_stats *s)
+{
+    assert(s);
+
+    s->files       = __atomic_load_n(&stats.files, __ATOMIC_RELAXED);
+    s->flush_ns    = __atomic_load_n(&stats.flush_ns, __ATOMIC_RELAXED);
+    s->datasync_ns = __atomic_load_n(&stats.datasync_ns, __ATOMIC_RELAXED);
+    s->rename_ns   = __atomic_load_n(&stats.rename_ns, __ATOMIC_RELAXED);
+    s->dirsync_ns  = __atomic_load_n(&stats.dirsync_ns, __ATOMIC_RELAXED);
+}
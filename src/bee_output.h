@@ -0,0 +1,64 @@
+/*
+** bee_output - replace output files atomically and optionally durably
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_OUTPUT_H
+#define BEE_OUTPUT_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* fdatasync() the data before and fsync() the directory after the rename */
+#define BEE_OUTPUT_SYNC    1
+/* write to an unnamed O_TMPFILE that only gets a name once it is complete */
+#define BEE_OUTPUT_TMPFILE 2
+
+/*
+ * output is written to <name>.<pid> (or an O_TMPFILE in the directory of
+ * <name>) and renamed over <name> by bee_output_commit()
+ */
+struct bee_output {
+    char *name;
+    char *tmpname;
+    int  fd;
+    FILE *fh;
+    int  flags;
+    int  tmpfile;
+};
+
+/* time spent in bee_output_commit() by all outputs of the process */
+struct bee_output_stats {
+    uint64_t files;
+    uint64_t flush_ns;
+    uint64_t datasync_ns;
+    uint64_t rename_ns;
+    uint64_t dirsync_ns;
+};
+
+FILE *bee_output_open(struct bee_output *out, char *name, int flags);
+int   bee_output_commit(struct bee_output *out);
+void  bee_output_abort(struct bee_output *out);
+
+void  bee_output_stats(struct bee_output_stats *stats);
+
+#endif
@@ -0,0 +1,517 @@
+/*
+** bee_paths - select the lines of a merged inventory path by path
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bee_paths.h"
+#include "bee_sort.h"
+
+/*
+ * per path selection
+ *
+ * lines written to the stream returned by bee_paths_open() must be in
+ * the order of a merged inventory so all lines of a path follow each
+ * other. what is written to the underlying output depends on the mode:
+ *
+ * BEE_PATHS_CONFLICTS: a line of another package conflicts with a line of
+ *   <pkg> of the same path if size or md5 differ, unless both packages
+ *   share the full name (other versions of <pkg> are replaced, not
+ *   conflicting). the conflicting lines of the other packages are written
+ *   sorted by package and path on close.
+ * BEE_PATHS_CONFLICTING_FILES: the lines of <pkg> conflicting with others.
+ * BEE_PATHS_UNIQUE: the lines of <pkg> whose path no other package has.
+ * BEE_PATHS_UNLINK: like BEE_PATHS_UNIQUE but the files are removed and
+ *   only the lines of removed files are written. as paths come in reverse
+ *   order the contents of a directory are removed before the directory
+ *   itself.
+ *
+ * all but BEE_PATHS_CONFLICTS write in input order.
+ */
+
+struct bee_paths {
+    FILE *out;
+    int  mode;
+
+    char   *pkg;
+    size_t pkglen;
+    size_t fullnamelen;
+
+    /* lines of the current path followed by data not yet scanned */
+    char   *buf;
+    size_t len;
+    size_t size;
+    size_t scanned;
+
+    /* offsets of the lines of the current path and of the path in buf */
+    size_t *lines;
+    size_t nlines;
+    size_t nlinesalloc;
+    size_t key;
+
+    /* indexes of the lines of <pkg> in lines */
+    size_t *targets;
+    size_t ntargets;
+    size_t ntargetsalloc;
+
+    char   **found;
+    size_t nfound;
+    size_t nfoundalloc;
+
+    /* directory of the last file removed with BEE_PATHS_UNLINK */
+    char *dir;
+    int  dirfd;
+
+    int failed;
+};
+
+/*
+ * length of the full name in <name>-<version>-<revision>.<arch> like
+ * 'beeversion --pkgfullname' or 0 if pkg has no version and revision
+ */
+static size_t pkg_fullname_len(const char *pkg, size_t len)
+{
+    const char *rev, *ver;
+
+    rev = memrchr(pkg, '-', len);
+    if (!rev || rev == pkg || rev == pkg + len - 1)
+        return 0;
+
+    ver = memrchr(pkg, '-', rev - pkg);
+    if (!ver || ver == pkg || ver == rev - 1)
+        return 0;
+
+    return ver - pkg;
+}
+
+static int paths_is_target(struct bee_paths *c, char *line)
+{
+    return !strncmp(line, c->pkg, c->pkglen) && line[c->pkglen] == ' ';
+}
+
+/* is line of <pkg> or of another version of it? */
+static int paths_same_name(struct bee_paths *c, char *line)
+{
+    size_t len;
+
+    len = pkg_fullname_len(line, strcspn(line, " "));
+
+    return len == c->fullnamelen && !memcmp(line, c->pkg, len);
+}
+
+/* do size or md5 of two lines of the same path differ? */
+static int conflicts_differ(char *a, char *b)
+{
+    char *sa, *sb;
+    size_t la, lb;
+
+    sa = bee_sort_skip_fields(a, 5);
+    sb = bee_sort_skip_fields(b, 5);
+    la = bee_sort_key(sa) - sa;
+    lb = bee_sort_key(sb) - sb;
+
+    return la != lb || memcmp(sa, sb, la);
+}
+
+static int paths_add(struct bee_paths *c, char *line)
+{
+    char **found;
+    size_t n;
+
+    if (c->nfound == c->nfoundalloc) {
+        n = c->nfoundalloc ? c->nfoundalloc * 2 : 64;
+        found = realloc(c->found, n * sizeof(*found));
+        if (!found) {
+            perror("realloc");
+            return 0;
+        }
+        c->found       = found;
+        c->nfoundalloc = n;
+    }
+
+    c->found[c->nfound] = strdup(line);
+    if (!c->found[c->nfound]) {
+        perror("strdup");
+        return 0;
+    }
+    c->nfound++;
+
+    return 1;
+}
+
+/* remove the file of line and write line if it was removed */
+static void paths_unlink(struct bee_paths *c, char *line)
+{
+    char *path, *slash, *name;
+    size_t len;
+    int res;
+
+    path  = bee_sort_key(line) + 1;
+    slash = strrchr(path, '/');
+    if (!slash || !slash[1]) {
+        fprintf(stderr, "bee-paths: %s: Not removing path\n", path);
+        return;
+    }
+
+    name = slash + 1;
+    len  = (slash == path) ? 1 : slash - path;
+
+    /* files of a directory follow each other, so keep it open */
+    if (!c->dir || strlen(c->dir) != len || strncmp(c->dir, path, len)) {
+        if (c->dirfd >= 0)
+            close(c->dirfd);
+        free(c->dir);
+
+        c->dir = strndup(path, len);
+        if (!c->dir) {
+            perror("strndup");
+            c->dirfd = -1;
+            return;
+        }
+
+        c->dirfd = open(c->dir, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+        if (c->dirfd < 0 && errno != ENOENT)
+            fprintf(stderr, "bee-paths: %s: %m\n", c->dir);
+    }
+
+    if (c->dirfd < 0)
+        return;
+
+    res = unlinkat(c->dirfd, name, 0);
+    if (res < 0 && (errno == EISDIR || errno == EPERM))
+        res = unlinkat(c->dirfd, name, AT_REMOVEDIR);
+
+    if (res < 0) {
+        /* like rm -f missing files are no error */
+        if (errno != ENOENT)
+            fprintf(stderr, "bee-paths: %s: %m\n", path);
+        return;
+    }
+
+    fputs(line, c->out);
+    fputc('\n', c->out);
+}
+
+/* write or remove the lines of the current path if all are of <pkg> */
+static int paths_unique(struct bee_paths *c)
+{
+    char *line;
+    size_t i;
+
+    for (i = 0; i < c->nlines; i++) {
+        if (!paths_is_target(c, c->buf + c->lines[i]))
+            return 1;
+    }
+
+    for (i = 0; i < c->nlines; i++) {
+        line = c->buf + c->lines[i];
+
+        if (c->mode == BEE_PATHS_UNLINK) {
+            paths_unlink(c, line);
+        } else {
+            fputs(line, c->out);
+            fputc('\n', c->out);
+        }
+    }
+
+    return 1;
+}
+
+/* check the lines of the current path */
+static int paths_group(struct bee_paths *c)
+{
+    char *line, *other;
+    size_t i, t, n;
+    size_t *targets;
+
+    if (c->mode == BEE_PATHS_UNIQUE || c->mode == BEE_PATHS_UNLINK)
+        return paths_unique(c);
+
+    if (c->nlines < 2)
+        return 1;
+
+    c->ntargets = 0;
+
+    for (i = 0; i < c->nlines; i++) {
+        if (!paths_is_target(c, c->buf + c->lines[i]))
+            continue;
+
+        if (c->ntargets == c->ntargetsalloc) {
+            n = c->ntargetsalloc ? c->ntargetsalloc * 2 : 8;
+            targets = realloc(c->targets, n * sizeof(*targets));
+            if (!targets) {
+                perror("realloc");
+                return 0;
+            }
+            c->targets       = targets;
+            c->ntargetsalloc = n;
+        }
+        c->targets[c->ntargets++] = i;
+    }
+
+    if (!c->ntargets)
+        return 1;
+
+    if (c->mode == BEE_PATHS_CONFLICTING_FILES) {
+        for (t = 0; t < c->ntargets; t++) {
+            line = c->buf + c->lines[c->targets[t]];
+
+            for (i = 0; i < c->nlines; i++) {
+                other = c->buf + c->lines[i];
+                if (!paths_same_name(c, other) && conflicts_differ(line, other)) {
+                    fputs(line, c->out);
+                    fputc('\n', c->out);
+                    break;
+                }
+            }
+        }
+
+        return 1;
+    }
+
+    for (i = 0; i < c->nlines; i++) {
+        other = c->buf + c->lines[i];
+        if (paths_same_name(c, other))
+            continue;
+
+        for (t = 0; t < c->ntargets; t++) {
+            if (conflicts_differ(c->buf + c->lines[c->targets[t]], other)) {
+                if (!paths_add(c, other))
+                    return 0;
+                break;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* scan the complete lines in c->buf and keep only those of the current path */
+static int paths_scan(struct bee_paths *c)
+{
+    size_t *lines;
+    size_t i, n, drop;
+    char *line, *key, *nl;
+    int cmp;
+
+    while ((nl = memchr(c->buf + c->scanned, '\n', c->len - c->scanned))) {
+        *nl  = '\0';
+        line = c->buf + c->scanned;
+        key  = bee_sort_key(line);
+
+        cmp = c->nlines ? strcmp(key, c->buf + c->key) : 0;
+
+        /* a path seen before would be grouped wrong */
+        if (cmp > 0) {
+            fprintf(stderr, "bee-paths: Not sorted by path: %s\n", line);
+            return 0;
+        }
+
+        if (cmp) {
+            if (!paths_group(c))
+                return 0;
+            c->nlines = 0;
+        }
+
+        if (!c->nlines)
+            c->key = key - c->buf;
+
+        if (c->nlines == c->nlinesalloc) {
+            n = c->nlinesalloc ? c->nlinesalloc * 2 : 64;
+            lines = realloc(c->lines, n * sizeof(*lines));
+            if (!lines) {
+                perror("realloc");
+                return 0;
+            }
+            c->lines       = lines;
+            c->nlinesalloc = n;
+        }
+        c->lines[c->nlines++] = c->scanned;
+
+        c->scanned = nl - c->buf + 1;
+    }
+
+    drop = c->nlines ? c->lines[0] : c->scanned;
+    if (!drop)
+        return 1;
+
+    memmove(c->buf, c->buf + drop, c->len - drop);
+    c->len     -= drop;
+    c->scanned -= drop;
+    if (c->nlines)
+        c->key -= drop;
+    for (i = 0; i < c->nlines; i++)
+        c->lines[i] -= drop;
+
+    return 1;
+}
+
+static ssize_t paths_write(void *cookie, const char *data, size_t size)
+{
+    struct bee_paths *c = cookie;
+    size_t nsize;
+    char *buf;
+
+    if (c->failed)
+        return -1;
+
+    if (c->len + size > c->size) {
+        nsize = c->size ? c->size : 65536;
+        while (nsize < c->len + size)
+            nsize *= 2;
+
+        buf = realloc(c->buf, nsize);
+        if (!buf) {
+            perror("realloc");
+            c->failed = 1;
+            return -1;
+        }
+        c->buf  = buf;
+        c->size = nsize;
+    }
+
+    memcpy(c->buf + c->len, data, size);
+    c->len += size;
+
+    if (!paths_scan(c)) {
+        c->failed = 1;
+        return -1;
+    }
+
+    return size;
+}
+
+/* by package and then by path */
+static int compare_found(const void *a, const void *b)
+{
+    char *x = *(char **)a, *y = *(char **)b;
+    size_t lx, ly;
+    int cmp;
+
+    lx  = strcspn(x, " ");
+    ly  = strcspn(y, " ");
+    cmp = memcmp(x, y, lx < ly ? lx : ly);
+    if (cmp)
+        return cmp;
+    if (lx != ly)
+        return lx < ly ? -1 : 1;
+
+    return strcmp(bee_sort_key(x), bee_sort_key(y));
+}
+
+static int paths_close(void *cookie)
+{
+    struct bee_paths *c = cookie;
+    int res = !c->failed;
+    size_t i;
+
+    if (res && c->len > c->scanned)
+        res = (paths_write(c, "\n", 1) == 1);
+
+    if (res)
+        res = paths_group(c);
+
+    if (res) {
+        qsort(c->found, c->nfound, sizeof(*c->found), compare_found);
+
+        for (i = 0; i < c->nfound; i++) {
+            fputs(c->found[i], c->out);
+            fputc('\n', c->out);
+        }
+
+        if (ferror(c->out)) {
+            fprintf(stderr, "bee-paths: writing selected lines failed: %m\n");
+            res = 0;
+        }
+    }
+
+    for (i = 0; i < c->nfound; i++)
+        free(c->found[i]);
+
+    if (c->dirfd >= 0)
+        close(c->dirfd);
+
+    free(c->dir);
+    free(c->found);
+    free(c->targets);
+    free(c->lines);
+    free(c->buf);
+    free(c);
+
+    return res ? 0 : EOF;
+}
+
+/*
+ * RETURN: stream to write a merged inventory to, fclose() writes the
+ *         remaining lines selected by mode to out and returns EOF if
+ *         anything failed
+ */
+FILE *bee_paths_open(FILE *out, char *pkg, int mode)
+{
+    struct bee_paths *c;
+    cookie_io_functions_t io = {
+        .write = paths_write,
+        .close = paths_close,
+    };
+    size_t fullnamelen;
+    FILE *fh;
+
+    assert(out);
+    assert(pkg);
+
+    fullnamelen = pkg_fullname_len(pkg, strlen(pkg));
+    if ((!fullnamelen && mode <= BEE_PATHS_CONFLICTING_FILES) || strchr(pkg, ' ')) {
+        fprintf(stderr, "bee-paths: %s: Can't parse bee-package.\n", pkg);
+        return NULL;
+    }
+
+    c = calloc(1, sizeof(*c));
+    if (!c) {
+        perror("calloc");
+        return NULL;
+    }
+
+    c->out         = out;
+    c->mode        = mode;
+    c->pkg         = pkg;
+    c->pkglen      = strlen(pkg);
+    c->fullnamelen = fullnamelen;
+    c->dirfd       = -1;
+
+    fh = fopencookie(c, "w", io);
+    if (!fh) {
+        perror("fopencookie");
+        free(c);
+    }
+
+    return fh;
+}
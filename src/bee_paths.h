@@ -0,0 +1,38 @@
+/*
+** bee_paths - select the lines of a merged inventory path by path
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_PATHS_H
+#define BEE_PATHS_H 1
+
+#include <stdio.h>
+
+/* modes of bee_paths_open() */
+#define BEE_PATHS_CONFLICTS         0
+#define BEE_PATHS_CONFLICTING_FILES 1
+#define BEE_PATHS_UNIQUE            2
+#define BEE_PATHS_UNLINK            3
+
+FILE *bee_paths_open(FILE *out, char *pkg, int mode);
+
+#endif
@@ -0,0 +1,226 @@
+/*
+** bee_pool - run jobs on a pool of threads
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "bee_pool.h"
+
+struct pool_job {
+    char   *buffer;
+    size_t size;
+    int    done;
+    int    res;
+};
+
+struct pool {
+    bee_pool_job run;
+    void *arg;
+    int  stitch;
+
+    struct pool_job *jobs;
+    size_t njobs;
+    size_t next;
+    int    failed;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  finished;
+};
+
+/* run a single job into its own buffer if the output is stitched */
+static int pool_run_job(struct pool *pool, size_t i)
+{
+    struct pool_job *job = &pool->jobs[i];
+    FILE *fh;
+    int res;
+
+    if (!pool->stitch)
+        return pool->run(pool->arg, i, NULL);
+
+    fh = open_memstream(&job->buffer, &job->size);
+    if (!fh) {
+        perror("open_memstream");
+        return 0;
+    }
+
+    res = pool->run(pool->arg, i, fh);
+
+    if (fclose(fh) == EOF) {
+        perror("fclose");
+        res = 0;
+    }
+
+    return res;
+}
+
+static void *pool_worker(void *arg)
+{
+    struct pool *pool = arg;
+    size_t i;
+    int res;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        if (pool->failed || pool->next == pool->njobs) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        i = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+
+        res = pool_run_job(pool, i);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->jobs[i].res  = res;
+        pool->jobs[i].done = 1;
+        if (!res)
+            pool->failed = 1;
+        pthread_cond_broadcast(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/*
+ * wait for the jobs in order and copy their buffers to out so the
+ * output does not depend on which worker finished first
+ */
+static int pool_stitch(struct pool *pool, FILE *out)
+{
+    struct pool_job *job;
+    size_t i;
+
+    for (i = 0; i < pool->njobs; i++) {
+        job = &pool->jobs[i];
+
+        pthread_mutex_lock(&pool->lock);
+        while (!job->done && !(pool->failed && i >= pool->next))
+            pthread_cond_wait(&pool->finished, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (!job->done || !job->res)
+            return 0;
+
+        if (job->size && fwrite(job->buffer, job->size, 1, out) != 1) {
+            perror("fwrite");
+            return 0;
+        }
+
+        free(job->buffer);
+        job->buffer = NULL;
+    }
+
+    return 1;
+}
+
+/*
+ * run jobs 0..njobs-1 on up to nthreads threads. no further jobs are
+ * started once one failed.
+ *
+ * with out each job writes to its own buffer and the buffers are written
+ * to out in the order of the jobs, otherwise the jobs get no output.
+ *
+ * RETURN: 1 if all jobs succeeded, 0 otherwise
+ */
+int bee_pool_run(size_t njobs, long nthreads, bee_pool_job run, void *arg, FILE *out)
+{
+    struct pool pool;
+    pthread_t *threads;
+    long i;
+    size_t j;
+    int res = 1;
+
+    assert(run);
+
+    memset(&pool, 0, sizeof(pool));
+
+    pool.run    = run;
+    pool.arg    = arg;
+    pool.stitch = (out != NULL);
+    pool.njobs  = njobs;
+
+    pool.jobs = calloc(njobs ? njobs : 1, sizeof(*pool.jobs));
+    if (!pool.jobs) {
+        perror("calloc");
+        return 0;
+    }
+
+    if ((size_t)nthreads > njobs)
+        nthreads = njobs;
+
+    threads = calloc(nthreads ? nthreads : 1, sizeof(*threads));
+    if (!threads) {
+        perror("calloc");
+        free(pool.jobs);
+        return 0;
+    }
+
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.finished, NULL);
+
+    for (i = 0; i < nthreads; i++) {
+        errno = pthread_create(&threads[i], NULL, pool_worker, &pool);
+        if (errno) {
+            perror("pthread_create");
+            break;
+        }
+    }
+
+    if (i < nthreads) {
+        /* let the running workers drain the queue alone */
+        nthreads = i;
+        if (!nthreads) {
+            pthread_mutex_lock(&pool.lock);
+            pool.failed = 1;
+            pthread_mutex_unlock(&pool.lock);
+        }
+    }
+
+    if (out)
+        res = pool_stitch(&pool, out);
+
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+
+    if (pool.failed)
+        res = 0;
+
+    pthread_cond_destroy(&pool.finished);
+    pthread_mutex_destroy(&pool.lock);
+
+    for (j = 0; j < njobs; j++)
+        free(pool.jobs[j].buffer);
+
+    free(threads);
+    free(pool.jobs);
+
+    return res;
+}
@@ -0,0 +1,38 @@
+/*
+** bee_pool - run jobs on a pool of threads
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_POOL_H
+#define BEE_POOL_H 1
+
+#include <stdio.h>
+
+/*
+ * a job writes its output to out and returns 1 on success or 0 on
+ * failure. out is NULL if the caller of bee_pool_run() passed none.
+ */
+typedef int (*bee_pool_job)(void *arg, size_t job, FILE *out);
+
+int bee_pool_run(size_t njobs, long nthreads, bee_pool_job run, void *arg, FILE *out);
+
+#endif
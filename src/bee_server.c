@@ -0,0 +1,220 @@
+/*
+** bee_server - line based request/response loop for coprocesses
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "bee_server.h"
+
+#define IS_BLANK(c) ((c) == ' ' || (c) == '\t')
+
+static struct bee_server_command *find_command(struct bee_server_command *commands, char *name)
+{
+    struct bee_server_command *cmd;
+
+    for (cmd = commands; cmd->name; cmd++) {
+        if (!strcmp(cmd->name, name))
+            return cmd;
+    }
+
+    return NULL;
+}
+
+/*
+ * split s into argv in place. at most max_args arguments are split
+ * off; the last one of those keeps the rest of the line including blanks.
+ *
+ * RETURN: number of arguments or -1 if argv could not be grown
+ */
+static int split_arguments(char *s, int max_args, char ***argv, int *size)
+{
+    char **new;
+    int argc = 0;
+
+    while (1) {
+        while (IS_BLANK(*s))
+            s++;
+
+        if (!*s)
+            break;
+
+        if (argc == *size) {
+            new = realloc(*argv, (*size + 16) * sizeof(**argv));
+            if (!new)
+                return -1;
+            *argv  = new;
+            *size += 16;
+        }
+
+        (*argv)[argc++] = s;
+
+        if (argc == max_args)
+            break;
+
+        while (*s && !IS_BLANK(*s))
+            s++;
+
+        if (!*s)
+            break;
+
+        *s++ = 0;
+    }
+
+    return argc;
+}
+
+static void respond(FILE *out, int status, char *buf, size_t len)
+{
+    size_t lines = 0;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (buf[i] == '\n')
+            lines++;
+    }
+
+    if (len && buf[len-1] != '\n')
+        lines++;
+
+    fprintf(out, "%d %zu\n", status, lines);
+
+    if (len) {
+        fwrite(buf, 1, len, out);
+        if (buf[len-1] != '\n')
+            fputc('\n', out);
+    }
+
+    fflush(out);
+}
+
+/*
+ * run the handler with its output captured in memory: the number of
+ * lines has to be known before the response can be sent.
+ *
+ * RETURN: 1 on success, 0 on fatal errors
+ */
+static int handle_request(struct bee_server_command *cmd, FILE *out, int argc, char *argv[])
+{
+    FILE *mem;
+    char *buf = NULL;
+    size_t len = 0;
+    int status;
+
+    mem = open_memstream(&buf, &len);
+    if (!mem) {
+        perror("open_memstream");
+        return 0;
+    }
+
+    status = cmd->handler(mem, argc, argv);
+
+    if (fclose(mem)) {
+        perror("fclose(memstream)");
+        free(buf);
+        return 0;
+    }
+
+    respond(out, status, buf, len);
+
+    free(buf);
+
+    return 1;
+}
+
+/*
+ * answer requests read from in until EOF. each request gets exactly one
+ * response so a client can always read it before sending the next one.
+ *
+ * RETURN: 1 on EOF, 0 on fatal errors
+ */
+int bee_server_run(char *program, struct bee_server_command *commands, FILE *in, FILE *out)
+{
+    struct bee_server_command *cmd;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    char **argv = NULL;
+    int asize = 0;
+    int argc;
+    char *name, *p;
+    int ret = 1;
+
+    assert(program);
+    assert(commands);
+    assert(in);
+    assert(out);
+
+    while ((len = getline(&line, &size, in)) != -1) {
+        if (len && line[len-1] == '\n')
+            line[--len] = 0;
+
+        for (name = line; IS_BLANK(*name); name++)
+            ;
+
+        for (p = name; *p && !IS_BLANK(*p); p++)
+            ;
+
+        if (*p)
+            *p++ = 0;
+
+        if (!*name) {
+            fprintf(stderr, "%s: empty request\n", program);
+            respond(out, BEE_SERVER_ERROR, NULL, 0);
+            continue;
+        }
+
+        cmd = find_command(commands, name);
+        if (!cmd) {
+            fprintf(stderr, "%s: unknown command '%s'\n", program, name);
+            respond(out, BEE_SERVER_ERROR, NULL, 0);
+            continue;
+        }
+
+        argc = split_arguments(p, cmd->max_args, &argv, &asize);
+        if (argc < 0) {
+            perror("realloc(argv)");
+            ret = 0;
+            break;
+        }
+
+        if (argc < cmd->min_args || (cmd->max_args != BEE_SERVER_UNLIMITED && argc > cmd->max_args)) {
+            fprintf(stderr, "%s: %s: wrong number of arguments\n", program, cmd->name);
+            respond(out, BEE_SERVER_ERROR, NULL, 0);
+            continue;
+        }
+
+        if (!handle_request(cmd, out, argc, argv)) {
+            ret = 0;
+            break;
+        }
+    }
+
+    free(argv);
+    free(line);
+
+    return ret;
+}
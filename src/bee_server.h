@@ -0,0 +1,63 @@
+/*
+** bee_server - line based request/response loop for coprocesses
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_SERVER_H
+#define BEE_SERVER_H 1
+
+#include <stdio.h>
+
+/*
+ * protocol:
+ *
+ *   request:  <command> [<arg1> .. <argN>]\n
+ *
+ *             arguments are separated by blanks. if a command takes at
+ *             most N arguments the N-th one is the rest of the line.
+ *
+ *   response: <status> <lines>\n
+ *             <lines> lines of output
+ *
+ *             status is one of the BEE_SERVER_* values below.
+ */
+
+#define BEE_SERVER_OK     0
+#define BEE_SERVER_FALSE  1
+#define BEE_SERVER_ERROR  2
+
+#define BEE_SERVER_UNLIMITED -1
+
+struct bee_server_command {
+    char *name;
+    int   min_args;
+    int   max_args;
+    int (*handler)(FILE *out, int argc, char *argv[]);
+};
+
+#define BEE_SERVER_COMMAND(n, min, max, h) \
+            { .name = (n), .min_args = (min), .max_args = (max), .handler = (h) }
+
+#define BEE_SERVER_COMMAND_END { .name = NULL }
+
+int bee_server_run(char *program, struct bee_server_command *commands, FILE *in, FILE *out);
+
+#endif
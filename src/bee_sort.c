@@ -0,0 +1,473 @@
+/*
+** bee_sort - sort and merge inventory lines
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "bee_sort.h"
+
+/*
+ * sorted output
+ *
+ * lines written to the stream returned by bee_sort_open() are
+ * collected in memory and written to the underlying output in the order
+ * of 'LC_ALL=C sort -r -k8 -k1' when the stream is closed. if more than
+ * the buffer size is collected the lines are spilled to sorted runs in
+ * $TMPDIR which are merged on close.
+ */
+
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+struct bee_sort {
+    FILE *out;
+    size_t bufsize;
+
+    char *buf;
+    size_t len;
+    size_t size;
+
+    struct bee_sort_run *runs;
+    size_t nruns;
+
+    int failed;
+};
+
+/* skip n fields like sort(1) without -b: each field is blanks followed by non blanks */
+char *bee_sort_skip_fields(char *line, int n)
+{
+    char *s = line;
+
+    while (n-- > 0) {
+        s += strspn(s, " \t");
+        s += strcspn(s, " \t");
+    }
+
+    return s;
+}
+
+/* start of key 8: the path including its leading blank */
+char *bee_sort_key(char *line)
+{
+    return bee_sort_skip_fields(line, 7);
+}
+
+/* sort -r -k8 -k1: compare key 8 and then the whole line, both reversed */
+static int sort_compare(const struct bee_sort_line *a, const struct bee_sort_line *b)
+{
+    int cmp;
+
+    cmp = strcmp(b->key, a->key);
+    if (cmp)
+        return cmp;
+
+    return strcmp(b->line, a->line);
+}
+
+static int sort_compare_qsort(const void *a, const void *b)
+{
+    return sort_compare(a, b);
+}
+
+/* sort the complete lines in s->buf[0..len) and write them to fh */
+static int sort_buffer(struct bee_sort *s, size_t len, FILE *fh)
+{
+    struct bee_sort_line *lines;
+    size_t nlines = 0, i;
+    char *p, *end, *nl;
+    int res = 1;
+
+    for (p = s->buf, end = s->buf + len; p < end; p = nl + 1) {
+        nl = memchr(p, '\n', end - p);
+        if (!nl)
+            break;
+        nlines++;
+    }
+
+    if (!nlines)
+        return 1;
+
+    lines = malloc(nlines * sizeof(*lines));
+    if (!lines) {
+        perror("malloc");
+        return 0;
+    }
+
+    for (i = 0, p = s->buf; i < nlines; i++, p = nl + 1) {
+        nl  = memchr(p, '\n', end - p);
+        *nl = '\0';
+        lines[i].line = p;
+        lines[i].key  = bee_sort_key(p);
+    }
+
+    qsort(lines, nlines, sizeof(*lines), sort_compare_qsort);
+
+    for (i = 0; i < nlines; i++) {
+        fputs(lines[i].line, fh);
+        fputc('\n', fh);
+    }
+
+    if (ferror(fh)) {
+        fprintf(stderr, "bee-sort: writing sorted output failed: %m\n");
+        res = 0;
+    }
+
+    free(lines);
+
+    return res;
+}
+
+static FILE *sort_tmpfile(void)
+{
+    char *tmpdir;
+    char *fname;
+    FILE *fh;
+    int fd;
+
+    tmpdir = getenv("TMPDIR");
+    if (!tmpdir || !*tmpdir)
+        tmpdir = "/tmp";
+
+    if (asprintf(&fname, "%s/bee-sort.XXXXXX", tmpdir) < 0) {
+        perror("asprintf");
+        return NULL;
+    }
+
+    fd = mkstemp(fname);
+    if (fd < 0) {
+        fprintf(stderr, "bee-sort: %s: %m\n", fname);
+        free(fname);
+        return NULL;
+    }
+
+    unlink(fname);
+    free(fname);
+
+    fh = fdopen(fd, "w+");
+    if (!fh) {
+        perror("fdopen");
+        close(fd);
+    }
+
+    return fh;
+}
+
+/* write all complete lines collected so far to a new sorted run */
+static int sort_spill(struct bee_sort *s)
+{
+    struct bee_sort_run *runs;
+    char *nl;
+    size_t len;
+    FILE *fh;
+
+    nl = memrchr(s->buf, '\n', s->len);
+    if (!nl)
+        return 1;
+
+    len = nl - s->buf + 1;
+
+    runs = realloc(s->runs, (s->nruns + 1) * sizeof(*runs));
+    if (!runs) {
+        perror("realloc");
+        return 0;
+    }
+    s->runs = runs;
+
+    fh = sort_tmpfile();
+    if (!fh)
+        return 0;
+
+    memset(&runs[s->nruns], 0, sizeof(*runs));
+    runs[s->nruns++].fh = fh;
+
+    if (!sort_buffer(s, len, fh))
+        return 0;
+
+    memmove(s->buf, s->buf + len, s->len - len);
+    s->len -= len;
+
+    return 1;
+}
+
+static ssize_t sort_write(void *cookie, const char *data, size_t size)
+{
+    struct bee_sort *s = cookie;
+    size_t nsize;
+    char *buf;
+
+    if (s->failed)
+        return -1;
+
+    if (s->len + size + 1 > s->size) {
+        nsize = s->size ? s->size : 65536;
+        while (nsize < s->len + size + 1)
+            nsize *= 2;
+
+        buf = realloc(s->buf, nsize);
+        if (!buf) {
+            perror("realloc");
+            s->failed = 1;
+            return -1;
+        }
+        s->buf  = buf;
+        s->size = nsize;
+    }
+
+    memcpy(s->buf + s->len, data, size);
+    s->len += size;
+
+    if (s->len >= s->bufsize && !sort_spill(s)) {
+        s->failed = 1;
+        return -1;
+    }
+
+    return size;
+}
+
+/* is the first field of line one of the packages in run->remove? */
+static int sort_run_removed(struct bee_sort_run *run, char *line)
+{
+    char *space;
+    void *found;
+
+    space = strchr(line, ' ');
+    if (!space)
+        return 0;
+
+    *space = '\0';
+    found  = bsearch(&line, run->remove, run->nremove, sizeof(*run->remove), compare_strings);
+    *space = ' ';
+
+    return found != NULL;
+}
+
+static int sort_run_next(struct bee_sort_run *run)
+{
+    ssize_t len;
+
+    do {
+        len = getline(&run->buf, &run->size, run->fh);
+        if (len < 0) {
+            run->current.line = NULL;
+            return 0;
+        }
+
+        if (len && run->buf[len-1] == '\n')
+            run->buf[len-1] = '\0';
+    } while (run->nremove && sort_run_removed(run, run->buf));
+
+    run->current.line = run->buf;
+    run->current.key  = bee_sort_key(run->buf);
+
+    return 1;
+}
+
+static void sort_heap_down(struct bee_sort_run **heap, size_t n, size_t i)
+{
+    struct bee_sort_run *tmp;
+    size_t min, c;
+
+    while (1) {
+        min = i;
+        for (c = 2*i + 1; c <= 2*i + 2 && c < n; c++) {
+            if (sort_compare(&heap[c]->current, &heap[min]->current) < 0)
+                min = c;
+        }
+
+        if (min == i)
+            return;
+
+        tmp       = heap[i];
+        heap[i]   = heap[min];
+        heap[min] = tmp;
+        i = min;
+    }
+}
+
+/*
+ * k-way merge of sorted runs to out like 'sort -m -r -k8 -k1'
+ * with unique set repeated lines are written once like 'sort -m -u'
+ *
+ * RETURN: 1 on success, 0 if a run is not sorted, reading a run or
+ *         writing out failed
+ */
+int bee_sort_merge(struct bee_sort_run *runs, size_t nruns, FILE *out, int unique)
+{
+    struct bee_sort_run **heap;
+    struct bee_sort_line prev;
+    size_t n = 0, i;
+    char *last = NULL;
+    size_t lastsize = 0, len;
+    int res = 1;
+
+    heap = calloc(nruns ? nruns : 1, sizeof(*heap));
+    if (!heap) {
+        perror("calloc");
+        return 0;
+    }
+
+    for (i = 0; i < nruns; i++) {
+        if (sort_run_next(&runs[i]))
+            heap[n++] = &runs[i];
+    }
+
+    for (i = n; i-- > 0; )
+        sort_heap_down(heap, n, i);
+
+    while (n) {
+        /* a run out of order would silently break the output order */
+        if (last && sort_compare(&prev, &heap[0]->current) > 0) {
+            fprintf(stderr, "bee-sort: %s: Not sorted like 'LC_ALL=C sort -r -k8 -k1': %s\n",
+                    heap[0]->name ? heap[0]->name : "sorted run", heap[0]->current.line);
+            res = 0;
+            break;
+        }
+
+        if (!unique || !last || strcmp(last, heap[0]->current.line)) {
+            fputs(heap[0]->current.line, out);
+            fputc('\n', out);
+        }
+
+        len = strlen(heap[0]->current.line) + 1;
+        if (len > lastsize) {
+            free(last);
+            lastsize = len;
+            last = malloc(lastsize);
+            if (!last) {
+                perror("malloc");
+                res = 0;
+                break;
+            }
+        }
+        memcpy(last, heap[0]->current.line, len);
+
+        prev.line = last;
+        prev.key  = last + (heap[0]->current.key - heap[0]->current.line);
+
+        if (!sort_run_next(heap[0]))
+            heap[0] = heap[--n];
+
+        sort_heap_down(heap, n, 0);
+    }
+
+    free(last);
+    free(heap);
+
+    for (i = 0; i < nruns; i++) {
+        if (ferror(runs[i].fh)) {
+            fprintf(stderr, "bee-sort: %s: Read failed: %m\n",
+                    runs[i].name ? runs[i].name : "sorted run");
+            res = 0;
+        }
+
+        free(runs[i].buf);
+        runs[i].buf  = NULL;
+        runs[i].size = 0;
+    }
+
+    if (ferror(out)) {
+        fprintf(stderr, "bee-sort: writing sorted output failed: %m\n");
+        res = 0;
+    }
+
+    return res;
+}
+
+/* merge all spilled runs to s->out */
+static int sort_merge_spilled(struct bee_sort *s)
+{
+    size_t i;
+
+    for (i = 0; i < s->nruns; i++)
+        rewind(s->runs[i].fh);
+
+    return bee_sort_merge(s->runs, s->nruns, s->out, 0);
+}
+
+static int sort_close(void *cookie)
+{
+    struct bee_sort *s = cookie;
+    int res = !s->failed;
+    size_t i;
+
+    /* terminate a last line without newline like sort(1) does */
+    if (res && s->len && s->buf[s->len-1] != '\n')
+        res = (sort_write(s, "\n", 1) == 1);
+
+    if (res && !s->nruns)
+        res = sort_buffer(s, s->len, s->out);
+    else if (res)
+        res = sort_spill(s) && sort_merge_spilled(s);
+
+    for (i = 0; i < s->nruns; i++) {
+        fclose(s->runs[i].fh);
+        free(s->runs[i].buf);
+    }
+
+    free(s->runs);
+    free(s->buf);
+    free(s);
+
+    return res ? 0 : EOF;
+}
+
+/*
+ * RETURN: stream to write unsorted lines to, fclose() writes them sorted
+ *         to out and returns EOF if anything failed
+ */
+FILE *bee_sort_open(FILE *out, size_t bufsize)
+{
+    struct bee_sort *s;
+    cookie_io_functions_t io = {
+        .write = sort_write,
+        .close = sort_close,
+    };
+    FILE *fh;
+
+    assert(out);
+
+    s = calloc(1, sizeof(*s));
+    if (!s) {
+        perror("calloc");
+        return NULL;
+    }
+
+    s->out     = out;
+    s->bufsize = bufsize;
+
+    fh = fopencookie(s, "w", io);
+    if (!fh) {
+        perror("fopencookie");
+        free(s);
+    }
+
+    return fh;
+}
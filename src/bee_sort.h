@@ -0,0 +1,61 @@
+/*
+** bee_sort - sort and merge inventory lines
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BEE_SORT_H
+#define BEE_SORT_H 1
+
+#include <stdio.h>
+
+/*
+ * inventory lines are sorted like 'LC_ALL=C sort -r -k8 -k1': by path
+ * and then by the whole line, both reversed.
+ */
+
+struct bee_sort_line {
+    char *line;
+    char *key;
+};
+
+/* a sorted input of bee_sort_merge() */
+struct bee_sort_run {
+    FILE *fh;
+    char *name;
+
+    /* sorted list of packages whose lines are skipped */
+    char **remove;
+    size_t nremove;
+
+    /* used while merging */
+    char *buf;
+    size_t size;
+    struct bee_sort_line current;
+};
+
+char *bee_sort_skip_fields(char *line, int n);
+char *bee_sort_key(char *line);
+
+FILE *bee_sort_open(FILE *out, size_t bufsize);
+int   bee_sort_merge(struct bee_sort_run *runs, size_t nruns, FILE *out, int unique);
+
+#endif
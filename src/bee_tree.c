@@ -7,6 +7,10 @@
 
 #include "bee_tree.h"
 
+#ifdef BEE_TREE_STATS
+struct bee_tree_stats bee_tree_stats;
+#endif
+
 static void *bee_tree_generate_key_default(const void *data)
 {
     assert(data);
@@ -43,18 +47,88 @@ struct bee_tree *bee_tree_allocate(void)
     return t;
 }
 
-static struct bee_subtree *bee_subtree_allocate(void)
+struct bee_tree *bee_tree_allocate_pooled(void)
+{
+    struct bee_tree *t;
+
+    if(!(t = bee_tree_allocate()))
+        return NULL;
+
+    t->flags |= BEE_TREE_FLAG_NODE_POOL;
+
+    return t;
+}
+
+static struct bee_subtree *bee_tree_chunk_node(struct bee_tree *tree)
+{
+    struct bee_tree_chunk *chunk;
+
+    assert(tree);
+
+    chunk = tree->chunks;
+
+    if (!chunk || chunk->used == chunk->size) {
+        chunk = malloc(sizeof(*chunk) + BEE_TREE_CHUNK_NODES * sizeof(chunk->nodes[0]));
+        if (!chunk)
+            return NULL;
+
+        chunk->used = 0;
+        chunk->size = BEE_TREE_CHUNK_NODES;
+        chunk->next = tree->chunks;
+
+        tree->chunks = chunk;
+    }
+
+    return &chunk->nodes[chunk->used++];
+}
+
+static struct bee_subtree *bee_subtree_allocate(struct bee_tree *tree)
 {
     struct bee_subtree *t;
 
-    if(!(t = calloc(1, sizeof(*t))))
+    assert(tree);
+
+    if (!(tree->flags & BEE_TREE_FLAG_NODE_POOL)) {
+        if(!(t = calloc(1, sizeof(*t))))
+            return NULL;
+
+        t->height = 1;
+
+        return t;
+    }
+
+    /* reuse deleted nodes first; they are chained via their parent pointer */
+    if ((t = tree->free_nodes))
+        tree->free_nodes = t->parent;
+    else if (!(t = bee_tree_chunk_node(tree)))
         return NULL;
 
+    memset(t, 0, sizeof(*t));
     t->height = 1;
 
     return t;
 }
 
+static void bee_subtree_release(struct bee_tree *tree, struct bee_subtree *node)
+{
+    assert(tree);
+    assert(node);
+
+    if (!(tree->flags & BEE_TREE_FLAG_NODE_POOL)) {
+        free(node);
+        return;
+    }
+
+    /* pooled nodes on the free list must not carry content */
+    node->key    = NULL;
+    node->data   = NULL;
+    node->left   = NULL;
+    node->right  = NULL;
+    node->parent = tree->free_nodes;
+
+    tree->free_nodes = node;
+}
+
 static void bee_node_free_content(struct bee_tree *tree, struct bee_subtree *node)
 {
     assert(tree);
@@ -88,10 +162,38 @@ static void bee_subtree_free(struct bee_tree *tree, struct bee_subtree *this)
     free(this);
 }
 
+static void bee_tree_free_chunks(struct bee_tree *tree)
+{
+    struct bee_tree_chunk *chunk, *next;
+    size_t i;
+
+    assert(tree);
+
+    for (chunk = tree->chunks; chunk; chunk = next) {
+        next = chunk->next;
+
+        /* released nodes have no content left so we can simply sweep all */
+        if (tree->free_data || tree->free_key) {
+            for (i = 0; i < chunk->used; i++)
+                bee_node_free_content(tree, &chunk->nodes[i]);
+        }
+
+        free(chunk);
+    }
+
+    tree->chunks     = NULL;
+    tree->free_nodes = NULL;
+}
+
 void bee_tree_free(struct bee_tree *tree)
 {
      assert(tree);
-     bee_subtree_free(tree, tree->root);
+
+     if (tree->flags & BEE_TREE_FLAG_NODE_POOL)
+         bee_tree_free_chunks(tree);
+     else
+         bee_subtree_free(tree, tree->root);
+
      free(tree);
 }
 
@@ -101,6 +203,10 @@ static void bee_tree_update_node(struct bee_subtree *node)
 
     assert(node);
 
+#ifdef BEE_TREE_STATS
+    bee_tree_stats.node_updates++;
+#endif
+
     l = BEE_TREE_HEIGHT(node->left);
     r = BEE_TREE_HEIGHT(node->right);
 
@@ -122,6 +228,10 @@ static struct bee_subtree *bee_subtree_rotate_left(struct bee_subtree *root)
     if (!root->right)
         return root;
 
+#ifdef BEE_TREE_STATS
+    bee_tree_stats.rotations++;
+#endif
+
     /* initialize rotation: point pivot to the new root */
     pivot         = root->right;
     pivot->parent = root->parent;
@@ -148,10 +258,7 @@ static struct bee_subtree *bee_subtree_rotate_left(struct bee_subtree *root)
     else
         pivot->parent->right = pivot;
 
-    while (root->parent) {
-        root = root->parent;
-        bee_tree_update_node(root);
-    }
+    /* ancestors are updated by the caller while retracing */
 
     return pivot;
 }
@@ -170,6 +277,10 @@ static struct bee_subtree *bee_subtree_rotate_right(struct bee_subtree *root)
     if (!root->left)
         return root;
 
+#ifdef BEE_TREE_STATS
+    bee_tree_stats.rotations++;
+#endif
+
     /* initialize rotation: point pivot to the new root */
     pivot         = root->left;
     pivot->parent = root->parent;
@@ -196,10 +307,7 @@ static struct bee_subtree *bee_subtree_rotate_right(struct bee_subtree *root)
     else
         pivot->parent->right = pivot;
 
-    while (root->parent) {
-        root = root->parent;
-        bee_tree_update_node(root);
-    }
+    /* ancestors are updated by the caller while retracing */
 
     return pivot;
 }
@@ -264,16 +372,28 @@ static void bee_node_print(struct bee_tree *tree, struct bee_subtree *node, int
 
 }
 
+/*
+ * retrace from node up to the root after node's subtree changed and
+ * rebalance where needed.
+ *
+ * all nodes above a subtree that kept its height are still valid, so we
+ * stop there. after an insert this happens at the latest after the first
+ * rotation, so an insert does O(1) rotations and node updates amortized.
+ */
 static void bee_tree_balance_node(struct bee_tree *tree, struct bee_subtree *node)
 {
     struct bee_subtree *child;
+    unsigned char height;
 
     while (node) {
+        height = node->height;
+
         bee_tree_update_node(node);
 
 #ifdef TREE_DEBUG
         printf("balancing ");
-	node_print(tree, node, 0, 0);
+        bee_node_print(tree, node, 0, 0);
+        putchar('\n');
 #endif
 
         if (node->balance_factor == -2) {
@@ -282,7 +402,7 @@ static void bee_tree_balance_node(struct bee_tree *tree, struct bee_subtree *nod
             if (child->balance_factor == 1)
                 bee_tree_rotate_right(tree, child);
 
-            bee_tree_rotate_left(tree, node);
+            node = bee_tree_rotate_left(tree, node);
 
         } else if (node->balance_factor == 2) {
             child = node->left;
@@ -290,18 +410,60 @@ static void bee_tree_balance_node(struct bee_tree *tree, struct bee_subtree *nod
             if (child->balance_factor == -1)
                 bee_tree_rotate_left(tree, child);
 
-            bee_tree_rotate_right(tree, node);
+            node = bee_tree_rotate_right(tree, node);
 
         }
 
+        if (node->height == height)
+            break;
+
         node = node->parent;
     }
 }
 
+/*
+ * compare two nodes in tree order. *dupe is set if b is a duplicate of a
+ * that must not be inserted due to the uniqueness flags of the tree.
+ */
+static int bee_tree_compare_nodes(struct bee_tree *tree, struct bee_subtree *a, struct bee_subtree *b, int *dupe)
+{
+    int cmp;
+
+    assert(tree);
+    assert(a);
+    assert(b);
+    assert(dupe);
+
+    *dupe = 0;
+
+    cmp = tree->compare_key(a->key, b->key);
+
+    if ((cmp == 0) && (tree->flags & (BEE_TREE_FLAG_UNIQUE|BEE_TREE_FLAG_UNIQUE_DATA))) {
+        /* do not insert dupes */
+        if (!(tree->flags & BEE_TREE_FLAG_UNIQUE_DATA)) {
+            *dupe = 1;
+            return 0;
+        }
+    }
+
+    if ((cmp == 0) && tree->flags & (BEE_TREE_FLAG_UNIQUE_DATA|BEE_TREE_FLAG_COMPARE_DATA_ON_EQUAL_KEY)) {
+
+        assert(tree->compare_data);
+
+        cmp = tree->compare_data(a->data, b->data);
+
+        if (cmp == 0 && (tree->flags & BEE_TREE_FLAG_UNIQUE_DATA))
+            *dupe = 1;
+    }
+
+    return cmp;
+}
+
 static struct bee_subtree *bee_tree_insert_node(struct bee_tree *tree, struct bee_subtree *node)
 {
     struct bee_subtree *current;
     int    cmp;
+    int    dupe;
 
     assert(tree);
     assert(node);
@@ -310,7 +472,8 @@ static struct bee_subtree *bee_tree_insert_node(struct bee_tree *tree, struct be
 
 #ifdef TREE_DEBUG
     printf("inserting ");
-    node_print(tree, node, 0, 0);
+    bee_node_print(tree, node, 0, 0);
+    putchar('\n');
 #endif
 
     if (!tree->root)
@@ -319,23 +482,10 @@ static struct bee_subtree *bee_tree_insert_node(struct bee_tree *tree, struct be
     current = tree->root;
 
     while (!node->parent) {
-        cmp = tree->compare_key(node->key, current->key);
-
-        if ((cmp == 0) && (tree->flags & (BEE_TREE_FLAG_UNIQUE|BEE_TREE_FLAG_UNIQUE_DATA))) {
-            /* do not insert dupes */
-            if (!(tree->flags & BEE_TREE_FLAG_UNIQUE_DATA))
-                return NULL;
-        }
-
-        if ((cmp == 0) && tree->flags & (BEE_TREE_FLAG_UNIQUE_DATA|BEE_TREE_FLAG_COMPARE_DATA_ON_EQUAL_KEY)) {
+        cmp = bee_tree_compare_nodes(tree, node, current, &dupe);
 
-            assert(tree->compare_data);
-
-            cmp = tree->compare_data(node->data, current->data);
-
-            if (cmp == 0 && (tree->flags & BEE_TREE_FLAG_UNIQUE_DATA))
-                return NULL;
-        }
+        if (dupe)
+            return NULL;
 
         if (cmp < 0) {
             if (current->left) {
@@ -373,7 +523,7 @@ struct bee_subtree *bee_tree_insert(struct bee_tree *tree, void *data)
 
     errno = 0;
 
-    node = bee_subtree_allocate();
+    node = bee_subtree_allocate(tree);
     if (!node)
         return NULL;
 
@@ -381,7 +531,7 @@ struct bee_subtree *bee_tree_insert(struct bee_tree *tree, void *data)
     node->key  = tree->generate_key(data);
 
     if (!node->key) {
-        free(node);
+        bee_subtree_release(tree, node);
         return NULL;
     }
 
@@ -391,12 +541,194 @@ struct bee_subtree *bee_tree_insert(struct bee_tree *tree, void *data)
     if (tree->free_key)
         tree->free_key(node->key);
 
-    free(node);
+    bee_subtree_release(tree, node);
 
     errno=EEXIST;
     return NULL;
 }
 
+static void bee_node_discard(struct bee_tree *tree, struct bee_subtree *node)
+{
+    assert(tree);
+    assert(node);
+
+    bee_node_free_content(tree, node);
+    bee_subtree_release(tree, node);
+}
+
+static void bee_subtree_swap(struct bee_subtree **nodes, size_t i, size_t j)
+{
+    struct bee_subtree *node;
+
+    node     = nodes[i];
+    nodes[i] = nodes[j];
+    nodes[j] = node;
+}
+
+static struct bee_subtree *bee_subtree_build(struct bee_subtree **nodes, size_t n, struct bee_subtree *parent)
+{
+    struct bee_subtree *root;
+    size_t mid;
+
+    if (!n)
+        return NULL;
+
+    mid  = n / 2;
+    root = nodes[mid];
+
+    root->parent = parent;
+    root->left   = bee_subtree_build(nodes, mid, root);
+    root->right  = bee_subtree_build(nodes + mid + 1, n - mid - 1, root);
+
+    bee_tree_update_node(root);
+
+    return root;
+}
+
+/*
+ * build an empty tree from data that is already sorted in tree order
+ *
+ * the longest ascending or descending run at the start of data (equal
+ * neighbours are allowed in both and keep their input order) is turned
+ * into a perfectly balanced tree in O(n). everything after that
+ * run is inserted the usual way, so unsorted input is handled correctly
+ * but does not benefit.
+ *
+ * the tree takes ownership of all data: elements generate_key() rejects
+ * with EINVAL and duplicates rejected by the uniqueness flags are freed
+ * via free_data. any other generate_key() failure fails the build.
+ *
+ * RETURN: number of elements in the tree
+ *         -1 on error; errno is set and data is still owned by the caller
+ */
+ssize_t bee_tree_build_sorted(struct bee_tree *tree, void **data, size_t n)
+{
+    struct bee_subtree **nodes;
+    struct bee_subtree *node;
+    size_t i, j, k, l, m, run;
+    int dupe, err;
+
+    assert(tree);
+    assert(!tree->root);
+    assert(data || !n);
+
+    assert(tree->generate_key);
+
+    if (!n)
+        return 0;
+
+    nodes = malloc(n * sizeof(*nodes));
+    if (!nodes)
+        return -1;
+
+    for (i = 0, m = 0; i < n; i++) {
+        node = bee_subtree_allocate(tree);
+        if (!node) {
+            errno = ENOMEM;
+            goto failed;
+        }
+
+        errno = 0;
+        node->data = data[i];
+        node->key  = tree->generate_key(data[i]);
+
+        if (!node->key) {
+            err = errno;
+            bee_subtree_release(tree, node);
+            if (err == EINVAL)
+                continue;
+            errno = err ? err : ENOMEM;
+            goto failed;
+        }
+
+        nodes[m++] = node;
+    }
+
+    /* from here on we own all data: free data without key */
+    if (tree->free_data) {
+        for (i = 0, j = 0; i < n; i++) {
+            if (j < m && nodes[j]->data == data[i])
+                j++;
+            else
+                tree->free_data(data[i]);
+        }
+    }
+
+    /* every element was rejected */
+    if (!m) {
+        free(nodes);
+        return 0;
+    }
+
+    /* find the longest ascending or descending run at the start,
+       equal neighbours are part of either */
+    for (run = 1; run < m; run++) {
+        if (bee_tree_compare_nodes(tree, nodes[run-1], nodes[run], &dupe) > 0)
+            break;
+    }
+
+    for (i = 1; run < m && i < m; i++) {
+        if (bee_tree_compare_nodes(tree, nodes[i-1], nodes[i], &dupe) < 0)
+            break;
+    }
+
+    if (run < i) {
+        run = i;
+
+        for (i = 0, j = run - 1; i < j; i++, j--)
+            bee_subtree_swap(nodes, i, j);
+
+        /* restore the input order of equal elements */
+        for (i = 0; i < run; i = k) {
+            for (k = i + 1; k < run; k++) {
+                if (bee_tree_compare_nodes(tree, nodes[k-1], nodes[k], &dupe))
+                    break;
+            }
+
+            for (l = i, j = k - 1; l < j; l++, j--)
+                bee_subtree_swap(nodes, l, j);
+        }
+    }
+
+    /* dupes are neighbours now */
+    for (i = 1, j = 1; i < run; i++) {
+        bee_tree_compare_nodes(tree, nodes[j-1], nodes[i], &dupe);
+        if (dupe) {
+            bee_node_discard(tree, nodes[i]);
+            continue;
+        }
+        nodes[j++] = nodes[i];
+    }
+
+    tree->root = bee_subtree_build(nodes, j, NULL);
+
+    for (i = run; i < m; i++) {
+        if (bee_tree_insert_node(tree, nodes[i]))
+            j++;
+        else
+            bee_node_discard(tree, nodes[i]);
+    }
+
+    free(nodes);
+
+    return j;
+
+failed:
+    err = errno;
+
+    while (m--) {
+        node = nodes[m];
+        if (tree->free_key)
+            tree->free_key(node->key);
+        bee_subtree_release(tree, node);
+    }
+
+    free(nodes);
+
+    errno = err;
+    return -1;
+}
+
 static struct bee_subtree *bee_tree_search_node_by_key(struct bee_tree *tree, void *key)
 {
     struct bee_subtree *node;
@@ -437,10 +769,8 @@ void *bee_tree_search(struct bee_tree *tree, void *key)
     return node->data;
 }
 
-static struct bee_subtree *bee_subtree_successor(struct bee_subtree *node)
+static struct bee_subtree *bee_subtree_min(struct bee_subtree *node)
 {
-    node = node->right;
-
     if (!node)
         return NULL;
 
@@ -450,6 +780,108 @@ static struct bee_subtree *bee_subtree_successor(struct bee_subtree *node)
     return node;
 }
 
+static struct bee_subtree *bee_subtree_max(struct bee_subtree *node)
+{
+    if (!node)
+        return NULL;
+
+    while (node->right)
+        node = node->right;
+
+    return node;
+}
+
+/* in-order cursor: first/last node of the tree or NULL if it is empty */
+struct bee_subtree *bee_tree_first(struct bee_tree *tree)
+{
+    assert(tree);
+
+    return bee_subtree_min(tree->root);
+}
+
+struct bee_subtree *bee_tree_last(struct bee_tree *tree)
+{
+    assert(tree);
+
+    return bee_subtree_max(tree->root);
+}
+
+/* in-order successor of node or NULL if node is the last one */
+struct bee_subtree *bee_subtree_next(struct bee_subtree *node)
+{
+    assert(node);
+
+    if (node->right)
+        return bee_subtree_min(node->right);
+
+    while (node->parent && node->parent->right == node)
+        node = node->parent;
+
+    return node->parent;
+}
+
+/* in-order predecessor of node or NULL if node is the first one */
+struct bee_subtree *bee_subtree_prev(struct bee_subtree *node)
+{
+    assert(node);
+
+    if (node->left)
+        return bee_subtree_max(node->left);
+
+    while (node->parent && node->parent->left == node)
+        node = node->parent;
+
+    return node->parent;
+}
+
+/* first node whose key is not less than key or NULL */
+struct bee_subtree *bee_tree_lower_bound(struct bee_tree *tree, void *key)
+{
+    struct bee_subtree *node, *bound = NULL;
+
+    assert(tree);
+    assert(key);
+
+    assert(tree->compare_key);
+
+    node = tree->root;
+
+    while (node) {
+        if (tree->compare_key(key, node->key) <= 0) {
+            bound = node;
+            node  = node->left;
+        } else {
+            node  = node->right;
+        }
+    }
+
+    return bound;
+}
+
+/* first node whose key is greater than key or NULL */
+struct bee_subtree *bee_tree_upper_bound(struct bee_tree *tree, void *key)
+{
+    struct bee_subtree *node, *bound = NULL;
+
+    assert(tree);
+    assert(key);
+
+    assert(tree->compare_key);
+
+    node = tree->root;
+
+    while (node) {
+        if (tree->compare_key(key, node->key) < 0) {
+            bound = node;
+            node  = node->left;
+        } else {
+            node  = node->right;
+        }
+    }
+
+    return bound;
+}
+
 static void bee_node_copy_content(struct bee_tree *tree, struct bee_subtree *from, struct bee_subtree *to)
 {
     assert(to);
@@ -463,17 +895,22 @@ static void bee_node_copy_content(struct bee_tree *tree, struct bee_subtree *fro
 
     to->key  = from->key;
     to->data = from->data;
+
+    /* content is moved: from must not free it again */
+    from->key  = NULL;
+    from->data = NULL;
 }
 
 static void bee_subtree_delete_node(struct bee_tree *tree, struct bee_subtree *node)
 {
     struct bee_subtree *n = NULL;
+    struct bee_subtree *parent;
 
     assert(tree);
     assert(node);
 
     if (node->left && node->right) {
-        n = bee_subtree_successor(node);
+        n = bee_subtree_min(node->right);
         bee_node_copy_content(tree, n, node);
         node = n;
         n = NULL;
@@ -500,12 +937,12 @@ static void bee_subtree_delete_node(struct bee_tree *tree, struct bee_subtree *n
         tree->root = n;
     }
 
-    if (!n)
-        n = node->parent;
+    /* retracing has to start at the parent: n's own height did not change */
+    parent = node->parent;
 
-    free(node);
+    bee_subtree_release(tree, node);
 
-    bee_tree_balance_node(tree, n);
+    bee_tree_balance_node(tree, parent);
 }
 
 
@@ -536,18 +973,6 @@ static void bee_subtree_print(struct bee_tree *tree, struct bee_subtree *node, i
     bee_subtree_print(tree, node->right, depth+1, 1);
 }
 
-static void bee_subtree_print_plain(struct bee_tree *tree, struct bee_subtree *node)
-{
-    assert(tree);
-
-    if (!node)
-        return;
-
-    bee_subtree_print_plain(tree, node->left);
-    bee_node_print(tree, node, 0, 0);
-    bee_subtree_print_plain(tree, node->right);
-}
-
 int bee_tree_set_flags(struct bee_tree *tree, int flags)
 {
     int oflags;
@@ -555,6 +980,9 @@ int bee_tree_set_flags(struct bee_tree *tree, int flags)
     assert(tree);
     assert(flags);
 
+    /* the node allocator can not be switched once nodes exist */
+    assert(!(flags & BEE_TREE_FLAG_NODE_POOL) || !(tree->root || tree->chunks));
+
     oflags = tree->flags;
     tree->flags |= flags;
 
@@ -568,6 +996,8 @@ int bee_tree_unset_flags(struct bee_tree *tree, int flags)
     assert(tree);
     assert(flags);
 
+    assert(!(flags & BEE_TREE_FLAG_NODE_POOL) || !(tree->root || tree->chunks));
+
     oflags = tree->flags;
     tree->flags &= ~flags;
 
@@ -583,7 +1013,10 @@ void bee_tree_print(struct bee_tree *tree)
 
 void bee_tree_print_plain(struct bee_tree *tree)
 {
+    struct bee_subtree *node;
+
     assert(tree);
 
-    bee_subtree_print_plain(tree, tree->root);
+    bee_tree_foreach(tree, node)
+        bee_node_print(tree, node, 0, 0);
 }
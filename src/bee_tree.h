@@ -2,11 +2,17 @@
 #ifndef _BEE_BEE_TREE_H
 #define _BEE_BEE_TREE_H 1
 
+#include <stddef.h>
+#include <sys/types.h>
+
 struct bee_tree {
     struct bee_subtree *root;
 
     int flags;
 
+    struct bee_tree_chunk *chunks;
+    struct bee_subtree    *free_nodes;
+
     void   (*free_data)(void *data);
 
     void * (*generate_key)(const void *data);
@@ -31,20 +37,60 @@ struct bee_subtree {
     void *data;
 };
 
+/* nodes are carved from chunks when BEE_TREE_FLAG_NODE_POOL is set */
+struct bee_tree_chunk {
+    struct bee_tree_chunk *next;
+
+    size_t used;
+    size_t size;
+
+    struct bee_subtree nodes[];
+};
+
+#define BEE_TREE_CHUNK_NODES 4096
+
 #define BEE_TREE_MAX(a,b)  (((a) > (b)) ? (a) : (b))
 #define BEE_TREE_HEIGHT(t) ((t) ? ((t)->height) : 0)
 
 #define BEE_TREE_FLAG_UNIQUE      (1<<0)
 #define BEE_TREE_FLAG_UNIQUE_DATA (1<<1)
 #define BEE_TREE_FLAG_COMPARE_DATA_ON_EQUAL_KEY (1<<2)
+#define BEE_TREE_FLAG_NODE_POOL   (1<<3)
+
+#ifdef BEE_TREE_STATS
+/* work done by all trees of the process, only counted if compiled in */
+struct bee_tree_stats {
+    unsigned long node_updates;
+    unsigned long rotations;
+};
+
+extern struct bee_tree_stats bee_tree_stats;
+#endif
 
 struct bee_tree *bee_tree_allocate(void);
+struct bee_tree *bee_tree_allocate_pooled(void);
 void bee_tree_free(struct bee_tree *tree);
 struct bee_subtree *bee_tree_insert(struct bee_tree *tree, void *data);
+ssize_t bee_tree_build_sorted(struct bee_tree *tree, void **data, size_t n);
 
 void *bee_tree_search(struct bee_tree *tree, void *key);
 void *bee_tree_delete(struct bee_tree *tree, void *key);
 
+struct bee_subtree *bee_tree_first(struct bee_tree *tree);
+struct bee_subtree *bee_tree_last(struct bee_tree *tree);
+struct bee_subtree *bee_subtree_next(struct bee_subtree *node);
+struct bee_subtree *bee_subtree_prev(struct bee_subtree *node);
+
+struct bee_subtree *bee_tree_lower_bound(struct bee_tree *tree, void *key);
+struct bee_subtree *bee_tree_upper_bound(struct bee_tree *tree, void *key);
+
+/* walk all nodes in order; node must not be deleted while walking */
+#define bee_tree_foreach(tree, node) \
+            for ((node) = bee_tree_first(tree); (node); (node) = bee_subtree_next(node))
+
+#define bee_tree_foreach_reverse(tree, node) \
+            for ((node) = bee_tree_last(tree); (node); (node) = bee_subtree_prev(node))
+
 void bee_tree_print(struct bee_tree *tree);
 void bee_tree_print_plain(struct bee_tree *tree);
 
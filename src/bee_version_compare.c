@@ -169,3 +169,141 @@ int compare_beepackages(struct beeversion *v1, struct beeversion *v2) {
     return(ret);
 }
 
+/*
+ * memcmp()-comparable sort keys
+ *
+ * a key encodes a parsed package so that comparing two keys with
+ * compare_beepackage_keys() orders packages like compare_beepackages():
+ *
+ *   pkgname \0 subname \0 <version> extraversion_typ <extraversion_nr> <pkgrevision>
+ *
+ * version strings are encoded as a sequence of tokens terminated by
+ * BEEKEY_END. the token classes sort like compare_version_strings() ranks
+ * characters: end of string < other < alpha < digit. digit runs are
+ * compared by value: leading zeros are dropped and the number of
+ * remaining digits is stored in front of them. runs of zeros only sort
+ * below any other number and among themselves by their length.
+ *
+ * the keys differ from compare_version_strings() only where it is not a
+ * consistent ordering: two different non-alphanumeric characters, zeros
+ * inside a number which it skips like leading zeros ("205" < "21" < "22"
+ * < "205"), numbers that overflow atoll() and strings starting with the
+ * same number written with a different count of leading zeros. the latter
+ * are equal for compare_version_strings() no matter what follows ("01.20"
+ * and "1.x") while "01.20" > "01.x" and "001.x" < "01.20", so no key can
+ * reproduce it. the keys drop the leading zeros and compare the rest. the
+ * old order of such packages depended on the order they were compared in.
+ *
+ * src/test-beekey.c checks that keys and compare_beepackages() agree
+ * everywhere else.
+ */
+
+#define BEEKEY_END    0
+#define BEEKEY_OTHER  1
+#define BEEKEY_ALPHA  2
+#define BEEKEY_NUMBER 3
+
+#define BEEKEY_MAX_LEN 255
+
+static inline void beekey_put(unsigned char *key, size_t size, size_t *len, unsigned char c)
+{
+    if (*len < size)
+        key[*len] = c;
+    (*len)++;
+}
+
+static void encode_version_string(char *s, unsigned char *key, size_t size, size_t *len)
+{
+    char *p;
+    size_t n;
+
+    assert(s);
+
+    while (*s) {
+        if (!isdigit(*s)) {
+            beekey_put(key, size, len, isalpha(*s) ? BEEKEY_ALPHA : BEEKEY_OTHER);
+            beekey_put(key, size, len, *s++);
+            continue;
+        }
+
+        beekey_put(key, size, len, BEEKEY_NUMBER);
+
+        for (p = s; *p == '0'; p++)
+            ;
+
+        if (!isdigit(*p)) {
+            /* zeros only: length 0 followed by the number of zeros */
+            n = p - s;
+            beekey_put(key, size, len, 0);
+            beekey_put(key, size, len, n < BEEKEY_MAX_LEN ? n : BEEKEY_MAX_LEN);
+            s = p;
+            continue;
+        }
+
+        for (s = p; isdigit(*p); p++)
+            ;
+
+        n = p - s;
+        beekey_put(key, size, len, n < BEEKEY_MAX_LEN ? n : BEEKEY_MAX_LEN);
+
+        while (s < p)
+            beekey_put(key, size, len, *s++);
+    }
+
+    beekey_put(key, size, len, BEEKEY_END);
+}
+
+static void encode_string(char *s, unsigned char *key, size_t size, size_t *len)
+{
+    assert(s);
+
+    while (*s)
+        beekey_put(key, size, len, *s++);
+
+    beekey_put(key, size, len, 0);
+}
+
+/*
+ * IN: v:    parsed package
+ *     key:  buffer receiving the key
+ *     size: size of key
+ *
+ * RETURN: length of the complete key; if it is greater than size the key
+ *         was truncated and has to be encoded again with a bigger buffer
+ */
+size_t encode_beepackage_key(struct beeversion *v, unsigned char *key, size_t size)
+{
+    size_t len = 0;
+
+    assert(v);
+    assert(key || !size);
+
+    encode_string(v->pkgname, key, size, &len);
+    encode_string(v->subname, key, size, &len);
+
+    encode_version_string(v->version, key, size, &len);
+
+    beekey_put(key, size, &len, v->extraversion_typ);
+
+    encode_version_string(v->extraversion_nr, key, size, &len);
+    encode_version_string(v->pkgrevision, key, size, &len);
+
+    return len;
+}
+
+int compare_beepackage_keys(unsigned char *a, size_t alen, unsigned char *b, size_t blen)
+{
+    int ret;
+
+    assert(a);
+    assert(b);
+
+    ret = memcmp(a, b, alen < blen ? alen : blen);
+    if (ret)
+        return ret;
+
+    if (alen < blen)
+        return -1;
+
+    return alen > blen;
+}
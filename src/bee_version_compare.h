@@ -28,3 +28,6 @@ int compare_version_strings(char *v1, char *v2);
 int compare_beepackage_names(struct beeversion *v1, struct beeversion *v2);
 int compare_beeversions(struct beeversion *v1, struct beeversion *v2);
 int compare_beepackages(struct beeversion *v1, struct beeversion *v2);
+
+size_t encode_beepackage_key(struct beeversion *v, unsigned char *key, size_t size);
+int compare_beepackage_keys(unsigned char *a, size_t alen, unsigned char *b, size_t blen);
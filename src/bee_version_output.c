@@ -24,7 +24,7 @@
 
 #include "bee_version.h"
 
-static void cut_and_print(char *string, char delimiter, char opt_short)
+static void cut_and_print(FILE *fh, char *string, char delimiter, char opt_short)
 {
     char *p, *s;
 
@@ -32,23 +32,23 @@ static void cut_and_print(char *string, char delimiter, char opt_short)
 
     p = s = string;
 
-    printf("%s", string);
+    fprintf(fh, "%s", string);
 
     while((p=strchr(p, delimiter))) {
-        putchar(' ');
+        fputc(' ', fh);
 
         while(s < p)
-            putchar(*(s++));
+            fputc(*(s++), fh);
 
         p++;
 
         s = (opt_short) ? p : string;
     }
 
-    printf(" %s", s);
+    fprintf(fh, " %s", s);
 }
 
-void print_format(char* s, struct beeversion *v, char *filter_pkgfullname)
+void fprint_format(FILE *fh, char* s, struct beeversion *v, char *filter_pkgfullname)
 {
     char *p;
     size_t len;
@@ -87,66 +87,66 @@ void print_format(char* s, struct beeversion *v, char *filter_pkgfullname)
         if(*p == '%') {
             switch(*(++p)) {
                 case '%':
-                    printf("%%");
+                    fprintf(fh, "%%");
                     break;
                 case 'p':
-                    printf("%s", v->pkgname);
+                    fprintf(fh, "%s", v->pkgname);
                     break;
                 case 's':
                     if(*(v->suffix))
-                        printf(".%s", v->suffix);
+                        fprintf(fh, ".%s", v->suffix);
                     break;
                 case 'x':
-                    printf("%s", v->subname);
+                    fprintf(fh, "%s", v->subname);
                     break;
                 case 'v':
-                    printf("%s", v->version);
+                    fprintf(fh, "%s", v->version);
                     break;
                 case 'e':
-                    printf("%s", v->extraversion);
+                    fprintf(fh, "%s", v->extraversion);
                     break;
                 case 'r':
-                    printf("%s", v->pkgrevision);
+                    fprintf(fh, "%s", v->pkgrevision);
                     break;
                 case 'a':
-                    printf("%s", v->arch);
+                    fprintf(fh, "%s", v->arch);
                     break;
                 case 'P':
-                    printf("%s", v->pkgname);
+                    fprintf(fh, "%s", v->pkgname);
                     if(*(v->subname))
-                        printf("_%s", v->subname);
+                        fprintf(fh, "_%s", v->subname);
                     break;
                 case 'V':
-                    printf("%s", v->version);
+                    fprintf(fh, "%s", v->version);
                     if(*(v->extraversion))
-                        printf("_%s", v->extraversion);
+                        fprintf(fh, "_%s", v->extraversion);
                     break;
                 case 'F':
                 case 'A':
                     if(*(v->pkgname))
-                        printf("%s", v->pkgname);
+                        fprintf(fh, "%s", v->pkgname);
                     if(*(v->subname))
-                        printf("_%s", v->subname);
+                        fprintf(fh, "_%s", v->subname);
                     if(*(v->version))
-                        printf("-%s", v->version);
+                        fprintf(fh, "-%s", v->version);
                     if(*(v->extraversion))
-                        printf("_%s", v->extraversion);
+                        fprintf(fh, "_%s", v->extraversion);
                     if(*(v->pkgrevision))
-                        printf("-%s", v->pkgrevision);
+                        fprintf(fh, "-%s", v->pkgrevision);
                     if(*p == 'A' && *(v->arch))
-                        printf(".%s", v->arch);
+                        fprintf(fh, ".%s", v->arch);
                     break;
             }
             if (*p) {
                 switch(*(p+1)) {
                     case 'x':
                         if (*(v->subname))
-                            printf("%c%s", *p, v->subname);
+                            fprintf(fh, "%c%s", *p, v->subname);
                         p++;
                         continue;
                     case 'e':
                         if (*(v->extraversion))
-                            printf("%c%s", *p, v->extraversion);
+                            fprintf(fh, "%c%s", *p, v->extraversion);
                         p++;
                         continue;
                 }
@@ -157,16 +157,16 @@ void print_format(char* s, struct beeversion *v, char *filter_pkgfullname)
         if(*p == '@') {
             switch(*(++p)) {
                 case 'v':
-                    cut_and_print(v->version, '.', 0);
+                    cut_and_print(fh, v->version, '.', 0);
                     break;
                 case 'e':
-                    cut_and_print(v->extraversion, '_', 0);
+                    cut_and_print(fh, v->extraversion, '_', 0);
                     break;
                 case 'V':
-                    cut_and_print(v->version, '.', 1);
+                    cut_and_print(fh, v->version, '.', 1);
                     break;
                 case 'E':
-                    cut_and_print(v->extraversion, '_', 1);
+                    cut_and_print(fh, v->extraversion, '_', 1);
                     break;
             }
             continue;
@@ -175,23 +175,28 @@ void print_format(char* s, struct beeversion *v, char *filter_pkgfullname)
         if(*p == '\\') {
             switch(*(++p)) {
                 case 'n':
-                    printf("\n");
+                    fprintf(fh, "\n");
                     break;
                 case 't':
-                    printf("\t");
+                    fprintf(fh, "\t");
                     break;
                 case '0':
-                    printf("%c", '\0');
+                    fprintf(fh, "%c", '\0');
                     break;
                 default:
-                    printf("%c", *p);
+                    fprintf(fh, "%c", *p);
                     break;
             }
             continue;
         } /* if '\' */
 
-        printf("%c", *p);
+        fprintf(fh, "%c", *p);
 
     } /* for *p */
 }
 
+
+void print_format(char* s, struct beeversion *v, char *filter_pkgfullname)
+{
+    fprint_format(stdout, s, v, filter_pkgfullname);
+}
@@ -18,6 +18,9 @@
 ** along with this program; if not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <stdio.h>
+
 #include "bee_version.h"
 
+void fprint_format(FILE *fh, char* s, struct beeversion *v, char *filter_pkgfullname);
 void print_format(char* s, struct beeversion *v, char *filter_pkgfullname);
@@ -77,23 +77,11 @@ char parse_extra(struct beeversion *v)
 #endif
     return(1);
 }
-/*
- * IN: string: pointer to versionstring..
- *          v: pointer to version structure..
- */
-void init_version(char *string, struct beeversion *v)
+static void init_version_pointers(struct beeversion *v)
 {
     char *s;
     size_t len;
 
-    assert(string);
-    assert(v);
-
-    if(! (v->string=strdup(string))) {
-        perror("strdup");
-        exit(254);
-    }
-
     s   = v->string;
     len = strlen(s);
 
@@ -110,21 +98,72 @@ void init_version(char *string, struct beeversion *v)
 
 /*
  * IN: string: pointer to versionstring..
- *          v: pointer to version structure
- *
- * OUT: filled structure on success..
- *
- * RETURN: 0  on success
- *         >0 error at position x
+ *          v: pointer to version structure..
+ */
+void init_version(char *string, struct beeversion *v)
+{
+    assert(string);
+    assert(v);
+
+    if(! (v->string=strdup(string))) {
+        perror("strdup");
+        exit(254);
+    }
+
+    init_version_pointers(v);
+}
+
+/*
+ * like init_version() but copy string to the caller's buffer instead of
+ * allocating a copy. v->string must not be freed afterwards.
  *
+ * RETURN: 1 on success, 0 if buffer is too small
  */
-int parse_version(char *string,  struct beeversion *v)
+int init_version_buffer(char *string, struct beeversion *v, char *buffer, size_t size)
+{
+    size_t len;
+
+    assert(string);
+    assert(v);
+    assert(buffer);
+
+    len = strlen(string);
+    if (len >= size)
+        return 0;
+
+    memmove(buffer, string, len+1);
+
+    v->string = buffer;
+
+    init_version_pointers(v);
+
+    return 1;
+}
+
+/* uname() only once per process */
+static const char *machine_name(void)
+{
+    static struct utsname unm;
+    static int initialized = 0;
+
+    if (initialized)
+        return unm.machine;
+
+    if(uname(&unm)) {
+         perror("uname");
+         exit(1);
+    }
+
+    initialized = 1;
+
+    return unm.machine;
+}
+
+static int parse_version_string(struct beeversion *v)
 {
     char   *p, *s;
     char   *version_or_revision;
 
-    init_version(string, v);
-
     s = v->string;
 
     /* p-v-r   p-v   v */
@@ -145,16 +184,10 @@ int parse_version(char *string,  struct beeversion *v)
 
     /* extract architecture if known.. */
     if((p=strrchr(s, '.')) && !strchr(++p, '-')) {
-        struct utsname unm;
         char           *arch[] = { SUPPORTED_ARCHITECTURES, NULL };
         char           **a;
 
-        if(uname(&unm)) {
-             perror("uname");
-             exit(1);
-        }
-
-        if(!strcmp(p, unm.machine)) {
+        if(!strcmp(p, machine_name())) {
             v->arch = p;
             *(p-1)  = 0;
         }
@@ -254,3 +287,36 @@ int parse_version(char *string,  struct beeversion *v)
     parse_extra(v);
     return(0);
 }
+
+/*
+ * IN: string: pointer to versionstring..
+ *          v: pointer to version structure
+ *
+ * OUT: filled structure on success..
+ *
+ * RETURN: 0  on success
+ *         >0 error at position x
+ *
+ */
+int parse_version(char *string,  struct beeversion *v)
+{
+    init_version(string, v);
+
+    return parse_version_string(v);
+}
+
+/*
+ * like parse_version() but v points into the caller's buffer afterwards:
+ * nothing is allocated. buffer may be string itself to parse in place.
+ *
+ * RETURN: 0  on success
+ *         >0 error at position x
+ *         -1 buffer too small
+ */
+int parse_version_buffer(char *string, struct beeversion *v, char *buffer, size_t size)
+{
+    if (!init_version_buffer(string, v, buffer, size))
+        return -1;
+
+    return parse_version_string(v);
+}
@@ -26,4 +26,6 @@
 
 char parse_extra(struct beeversion *v);
 int parse_version(char *s,  struct beeversion *v);
+int parse_version_buffer(char *s, struct beeversion *v, char *buffer, size_t size);
 void init_version(char *s, struct beeversion *v);
+int init_version_buffer(char *s, struct beeversion *v, char *buffer, size_t size);
@@ -28,7 +28,43 @@
 #include <string.h>
 #include <assert.h>
 #include <err.h>
-#include <regex.h>
+
+#include "bee_getopt.h"
+#include "bee_server.h"
+
+#define OPT_STREAM  256
+#define OPT_SERVER  257
+#define OPT_FIELDS  258
+#define OPT_FORMAT  259
+
+#define FORMAT_SHELL 0
+#define FORMAT_NUL   1
+#define FORMAT_TSV   2
+#define FORMAT_JSON  3
+
+struct beesep_pair {
+    char   *key;
+    size_t  keylen;
+    char   *value;
+    size_t  vallen;
+};
+
+struct beesep_ctl {
+    int     format;
+
+    /* shell format: print all pairs of a record in a single line */
+    int     oneline;
+
+    /* projection: only print these keys in this order */
+    char  **fields;
+    size_t *fieldlen;
+    int     nfields;
+
+    /* pairs of the current record: nfields slots if projecting */
+    struct beesep_pair *pairs;
+    int     npairs;
+    int     size;
+};
 
 #define bee_fprint(fh, str)  bee_fnprint(fh, 0, str)
 
@@ -39,12 +75,8 @@ static int bee_fnprint(FILE *fh, size_t n, char *str)
     if (ferror(fh))
         return 0;
 
-    m =  strlen(str);
-
-    assert(n <= m);
-
     if (!n)
-        n = m;
+        n = strlen(str);
 
     if (!n)
         return 1;
@@ -60,7 +92,7 @@ static int bee_fnprint(FILE *fh, size_t n, char *str)
     return 1;
 }
 
-static void print_escaped(char *s, size_t n)
+static void print_escaped(FILE *fh, char *s, size_t n, char *end)
 {
     char *c;
 
@@ -68,145 +100,547 @@ static void print_escaped(char *s, size_t n)
 
     c = s;
 
-    bee_fprint(stdout, "'");
+    bee_fprint(fh, "'");
 
-    while ((c = strchr(s, '\'')) && c - s < n) {
+    while ((c = memchr(s, '\'', n))) {
         if (c-s)
-            bee_fnprint(stdout, c - s, s);
-        bee_fprint(stdout, "'\\''");
+            bee_fnprint(fh, c - s, s);
+        bee_fprint(fh, "'\\''");
         n -= c - s + 1;
         s  = c + 1;
     }
 
     if (n)
-        bee_fnprint(stdout, n, s);
+        bee_fnprint(fh, n, s);
 
-    bee_fprint(stdout, "'\n");
+    bee_fprint(fh, "'");
+    bee_fprint(fh, end);
 }
 
-static int bee_regcomp(regex_t *preg, char *regex, int cflags)
+/* print s with tabs, newlines and backslashes escaped as \t, \n and \\ */
+static void print_tsv_escaped(FILE *fh, char *s, size_t n)
 {
-    int  regerr;
-    char errbuf[BUFSIZ];
+    char *p, *end;
 
-    regerr = regcomp(preg, regex, cflags);
+    end = s + n;
 
-    if (!regerr)
-        return 1;
+    for (p = s; p < end; p++) {
+        if (*p != '\t' && *p != '\n' && *p != '\\')
+            continue;
 
-    regerror(regerr, preg, errbuf, BUFSIZ);
-    warnx("bee_regcomp: %s\n", errbuf);
-    return 0;
+        if (p > s)
+            bee_fnprint(fh, p - s, s);
+
+        bee_fprint(fh, (*p == '\t') ? "\\t" : (*p == '\n') ? "\\n" : "\\\\");
+
+        s = p + 1;
+    }
+
+    if (end > s)
+        bee_fnprint(fh, end - s, s);
 }
 
-static short do_separation(char *str)
+/* print s as JSON string: bytes >= 0x80 are passed as they are */
+static void print_json_string(FILE *fh, char *s, size_t n)
 {
-    int   res=0;
-    int   r;
+    char *p, *end;
+    char buf[8];
 
-    int   start,
-          end;
+    end = s + n;
 
-    char *key,
-         *value;
-    int   keylen,
-          vallen;
+    bee_fprint(fh, "\"");
 
-    regex_t    regex_first;
-    regex_t    regex_next;
-    regmatch_t pmatch;
+    for (p = s; p < end; p++) {
+        if (*p != '"' && *p != '\\' && (unsigned char)*p >= 0x20)
+            continue;
 
-    /* compile regexes */
+        if (p > s)
+            bee_fnprint(fh, p - s, s);
 
-    r = bee_regcomp(&regex_first, "^[[:alnum:]]+=", REG_EXTENDED);
-    if (!r)
-        return 0;
+        if (*p == '"' || *p == '\\') {
+            buf[0] = '\\';
+            buf[1] = *p;
+            buf[2] = 0;
+        } else {
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)*p);
+        }
+
+        bee_fprint(fh, buf);
 
-    r = bee_regcomp(&regex_next, ":[[:alnum:]]+=", REG_EXTENDED);
-    if (!r)
-        goto out_first;
+        s = p + 1;
+    }
 
+    if (end > s)
+        bee_fnprint(fh, end - s, s);
 
-    /* match first key */
+    bee_fprint(fh, "\"");
+}
 
-    r = regexec(&regex_first, str, 1, &pmatch, 0);
-    if (r == REG_NOMATCH) {
-        warnx("String '%s' does not start with a key\n", str);
-        goto out;
+#define IS_KEYCHAR(c) (((c) >= 'a' && (c) <= 'z') || \
+                       ((c) >= 'A' && (c) <= 'Z') || \
+                       ((c) >= '0' && (c) <= '9'))
+
+/*
+ * find the next key in s..end: the leftmost ':' followed by one or more
+ * alphanumeric characters and a '=' (":[[:alnum:]]+=" in the C locale).
+ *
+ * RETURN: pointer to the ':' and *value set behind the '=', or NULL
+ */
+static char *find_next_key(char *s, char *end, char **value)
+{
+    char *c, *p;
+
+    while ((c = memchr(s, ':', end - s))) {
+        for (p = c + 1; p < end && IS_KEYCHAR(*p); p++)
+            ;
+
+        if (p > c + 1 && p < end && *p == '=') {
+            *value = p + 1;
+            return c;
+        }
+
+        /* no ':' can be hidden in the characters skipped so far */
+        s = p;
     }
 
-    /* init loop variables */
+    return NULL;
+}
 
-    end = pmatch.rm_eo;
+/*
+ * remember a pair of the current record
+ *
+ * RETURN: 1 if the pair was kept, 0 if it is not part of the projection
+ */
+static int add_pair(struct beesep_ctl *ctl, char *key, size_t keylen, char *value, size_t vallen)
+{
+    struct beesep_pair *pair = NULL;
+    int i;
+
+    if (ctl->nfields) {
+        for (i = 0; i < ctl->nfields; i++) {
+            pair = &ctl->pairs[i];
+
+            if (pair->key || ctl->fieldlen[i] != keylen)
+                continue;
+
+            if (!memcmp(ctl->fields[i], key, keylen))
+                break;
+        }
+
+        if (i == ctl->nfields)
+            return 0;
+    } else {
+        if (ctl->npairs == ctl->size) {
+            ctl->size = ctl->size ? 2 * ctl->size : 16;
+            ctl->pairs = realloc(ctl->pairs, ctl->size * sizeof(*ctl->pairs));
+            if (!ctl->pairs)
+                err(EXIT_FAILURE, "realloc(pairs)");
+        }
+
+        pair = &ctl->pairs[ctl->npairs++];
+    }
+
+    pair->key    = key;
+    pair->keylen = keylen;
+    pair->value  = value;
+    pair->vallen = vallen;
+
+    return 1;
+}
+
+static void reset_pairs(struct beesep_ctl *ctl)
+{
+    if (ctl->nfields)
+        memset(ctl->pairs, 0, ctl->nfields * sizeof(*ctl->pairs));
+
+    ctl->npairs = 0;
+}
+
+/*
+ * split str into the pairs of ctl. with a projection scanning stops
+ * right after the value of the last requested key has been found.
+ *
+ * RETURN: 1 on success, 0 if str does not start with a key
+ */
+static int split_pairs(struct beesep_ctl *ctl, char *str)
+{
+    char *key,
+         *value,
+         *next,
+         *nextvalue,
+         *end,
+         *p;
+    int found = 0;
 
-    key    = str;
-    value  = str+end;
+    reset_pairs(ctl);
 
-    /* always continue search for next match within value */
-    str = value;
+    end = str + strlen(str);
+
+    /* match first key */
+
+    for (p = str; IS_KEYCHAR(*p); p++)
+        ;
+
+    if (p == str || *p != '=') {
+        warnx("String '%s' does not start with a key\n", str);
+        return 0;
+    }
+
+    key   = str;
+    value = p + 1;
 
     /* match all other keys */
 
-    while (regexec(&regex_next, str, 1, &pmatch, 0) != REG_NOMATCH) {
-        start   = pmatch.rm_so;
-        end     = pmatch.rm_eo;
+    while (1) {
+        next = find_next_key(value, end, &nextvalue);
 
         /*
-                +--+ keylen
-                     +----+ vallen
-                     +-----+ start
-                     +-----------+ end
             ...:key1=value1:key2=value2:...
-                ^    ^      ^
-                |    |      |
-                key  value  (nextkey)
-                     str
+                ^    ^     ^    ^
+                |    |     |    |
+                key  value next nextvalue
         */
 
-        keylen = value-key-1;
-        vallen = start;
+        found += add_pair(ctl, key, value - key - 1, value, (next ? next : end) - value);
+
+        if (!next || (ctl->nfields && found == ctl->nfields))
+            break;
+
+        key   = next + 1;
+        value = nextvalue;
+    }
+
+    return 1;
+}
+
+/*
+ * print the pairs of the current record. requested keys that were not
+ * found are printed with empty values (null in JSON).
+ */
+static void print_record(FILE *fh, struct beesep_ctl *ctl)
+{
+    struct beesep_pair *pair;
+    char *key;
+    size_t keylen;
+    int n, i;
+
+    n = ctl->nfields ? ctl->nfields : ctl->npairs;
+
+    if (ctl->format == FORMAT_JSON)
+        bee_fprint(fh, "{");
+
+    for (i = 0; i < n; i++) {
+        pair = &ctl->pairs[i];
+
+        key    = ctl->nfields ? ctl->fields[i]   : pair->key;
+        keylen = ctl->nfields ? ctl->fieldlen[i] : pair->keylen;
+
+        switch (ctl->format) {
+            case FORMAT_SHELL:
+                bee_fnprint(fh, keylen, key);
+                bee_fprint(fh, "=");
+                print_escaped(fh, pair->value ? pair->value : "", pair->vallen,
+                              (ctl->oneline && i < n - 1) ? " " : "\n");
+                break;
+
+            case FORMAT_NUL:
+            case FORMAT_TSV:
+                if (ctl->format == FORMAT_TSV && i)
+                    bee_fprint(fh, "\t");
+
+                if (!ctl->nfields) {
+                    bee_fnprint(fh, keylen, key);
+                    bee_fprint(fh, "=");
+                }
+
+                if (pair->value && ctl->format == FORMAT_TSV)
+                    print_tsv_escaped(fh, pair->value, pair->vallen);
+                else if (pair->vallen)
+                    bee_fnprint(fh, pair->vallen, pair->value);
+
+                if (ctl->format == FORMAT_NUL)
+                    fputc(0, fh);
+                break;
+
+            case FORMAT_JSON:
+                if (i)
+                    bee_fprint(fh, ",");
+
+                print_json_string(fh, key, keylen);
+                bee_fprint(fh, ":");
+
+                if (pair->value)
+                    print_json_string(fh, pair->value, pair->vallen);
+                else
+                    bee_fprint(fh, "null");
+                break;
+        }
+    }
+
+    switch (ctl->format) {
+        case FORMAT_SHELL:
+            if (ctl->oneline && !n)
+                bee_fprint(fh, "\n");
+            break;
+
+        case FORMAT_NUL:
+            /* records of varying length end with an empty item */
+            if (!ctl->nfields)
+                fputc(0, fh);
+            break;
+
+        case FORMAT_TSV:
+            bee_fprint(fh, "\n");
+            break;
+
+        case FORMAT_JSON:
+            bee_fprint(fh, "}\n");
+            break;
+    }
+}
+
+static short do_separation(FILE *fh, struct beesep_ctl *ctl, char *str)
+{
+    if (!split_pairs(ctl, str))
+        return 0;
+
+    print_record(fh, ctl);
+
+    return !ferror(fh);
+}
+
+/* set by main() for the server handler */
+static struct beesep_ctl *server_ctl;
+
+/* server: separate <line> */
+static int server_separate(FILE *out, int argc, char *argv[])
+{
+    return do_separation(out, server_ctl, argv[0]) ? BEE_SERVER_OK : BEE_SERVER_ERROR;
+}
 
-        /* print current key/value pair */
+static int do_server(struct beesep_ctl *ctl)
+{
+    struct bee_server_command commands[] = {
+        BEE_SERVER_COMMAND("separate", 1, 1, server_separate),
+        BEE_SERVER_COMMAND_END
+    };
 
-        bee_fnprint(stdout, keylen+1, key);
-        print_escaped(value, vallen);
+    server_ctl = ctl;
 
-        /* reinit for next round */
+    return bee_server_run("beesep", commands, stdin, stdout);
+}
 
-        key   = str+start+1;
-        value = str+end;
-        str   = value;
+/*
+ * separate every line read from in and print it as a single record.
+ * lines that can't be separated are reported and printed as empty
+ * records so output records always match input lines.
+ */
+static int stream_file(FILE *in, FILE *out, struct beesep_ctl *ctl)
+{
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    int res = 1;
+
+    while ((len = getline(&line, &size, in)) != -1) {
+        if (len && line[len-1] == '\n')
+            line[--len] = 0;
+
+        if (!do_separation(out, ctl, line)) {
+            reset_pairs(ctl);
+            print_record(out, ctl);
+            res = 0;
+        }
     }
 
-    /* print last key/value pair */
+    if (ferror(in)) {
+        warn("getline");
+        res = 0;
+    }
 
-    keylen = value-key-1;
+    free(line);
 
-    bee_fnprint(stdout, keylen+1, key);
-    print_escaped(value, strlen(value));
+    return res;
+}
+
+/* stream all files or stdin if there are none: "-" is stdin too */
+static int do_stream(int argc, char *argv[], struct beesep_ctl *ctl)
+{
+    FILE *in;
+    int res = 1;
+    int i;
 
-    /* we are done -> set error-state and clean up */
+    if (!argc)
+        return stream_file(stdin, stdout, ctl);
 
-    res = !ferror(stdout);
+    for (i = 0; i < argc; i++) {
+        if (!strcmp(argv[i], "-")) {
+            res &= stream_file(stdin, stdout, ctl);
+            continue;
+        }
 
-out:
-    regfree(&regex_next);
+        in = fopen(argv[i], "r");
+        if (!in) {
+            warn("%s", argv[i]);
+            res = 0;
+            continue;
+        }
 
-out_first:
-    regfree(&regex_first);
+        res &= stream_file(in, stdout, ctl);
+
+        fclose(in);
+    }
+
+    if (fflush(stdout) || ferror(stdout))
+        res = 0;
 
     return res;
 }
 
+/* split the comma separated list of keys in place */
+static int parse_fields(struct beesep_ctl *ctl, char *list)
+{
+    char *p;
+    int n;
+
+    for (n = 1, p = list; *p; p++) {
+        if (*p == ',')
+            n++;
+    }
+
+    ctl->fields   = calloc(n, sizeof(*ctl->fields));
+    ctl->fieldlen = calloc(n, sizeof(*ctl->fieldlen));
+    ctl->pairs    = calloc(n, sizeof(*ctl->pairs));
+
+    if (!ctl->fields || !ctl->fieldlen || !ctl->pairs)
+        err(EXIT_FAILURE, "calloc(fields)");
+
+    for (n = 0, p = strtok(list, ","); p; p = strtok(NULL, ",")) {
+        ctl->fields[n]   = p;
+        ctl->fieldlen[n] = strlen(p);
+        n++;
+    }
+
+    if (!n) {
+        warnx("--fields: no keys given");
+        return 0;
+    }
+
+    ctl->nfields = n;
+    ctl->size    = n;
+
+    return 1;
+}
+
+static int parse_format(struct beesep_ctl *ctl, char *format)
+{
+    char *formats[] = { "shell", "nul", "tsv", "json", NULL };
+    int i;
+
+    for (i = 0; formats[i]; i++) {
+        if (!strcmp(format, formats[i])) {
+            ctl->format = i;
+            return 1;
+        }
+    }
+
+    warnx("--format: unknown format '%s'", format);
+    return 0;
+}
+
+static void usage(void)
+{
+    printf("usage: beesep [options] <line>\n"
+           "       beesep [options] --stream [<file> ..]\n"
+           "       beesep [options] --server\n\n"
+           "options:\n\n"
+           "    --fields=<key>[,<key>..]  print only these keys in this order\n"
+           "    --format=shell|nul|tsv|json\n\n"
+           "formats:\n\n"
+           "    shell  key='value' assignments: one per line or, with --stream,\n"
+           "           all assignments of a record in a single line (default)\n"
+           "    nul    items terminated by NUL: key=value and an empty item\n"
+           "           after each record or, with --fields, just the values\n"
+           "    tsv    one line per record: items separated by tabs\n"
+           "    json   one object per line\n");
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc != 2) {
+    struct beesep_ctl ctl;
+    int opt_stream = 0;
+    int opt_server = 0;
+    int res;
+
+    int opt;
+    int optindex;
+
+    struct bee_getopt_ctl optctl;
+    struct bee_option options[] = {
+        BEE_OPTION(BEE_OPT_LONG("stream"), BEE_OPT_VALUE(OPT_STREAM)),
+        BEE_OPTION(BEE_OPT_LONG("server"), BEE_OPT_VALUE(OPT_SERVER)),
+        BEE_OPTION(BEE_OPT_LONG("fields"), BEE_OPT_VALUE(OPT_FIELDS),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION(BEE_OPT_LONG("format"), BEE_OPT_VALUE(OPT_FORMAT),
+                   BEE_OPT_TYPE(BEE_TYPE_STRING), BEE_OPT_REQUIRED(1)),
+        BEE_OPTION_NO_ARG("help", 'h'),
+        BEE_OPTION_END
+    };
+
+    memset(&ctl, 0, sizeof(ctl));
+
+    bee_getopt_init(&optctl, argc-1, &argv[1], options);
+
+    optctl.program = "beesep";
+
+    while ((opt=bee_getopt(&optctl, &optindex)) != BEE_GETOPT_END) {
+
+        if (opt == BEE_GETOPT_ERROR)
+            return 1;
+
+        switch (opt) {
+            case OPT_STREAM:
+                opt_stream = 1;
+                break;
+
+            case OPT_SERVER:
+                opt_server = 1;
+                break;
+
+            case OPT_FIELDS:
+                if (!parse_fields(&ctl, optctl.optarg))
+                    return 1;
+                break;
+
+            case OPT_FORMAT:
+                if (!parse_format(&ctl, optctl.optarg))
+                    return 1;
+                break;
+
+            case 'h':
+                usage();
+                return 0;
+        }
+    }
+
+    argc = optctl.argc - optctl.optind;
+    argv = optctl.argv + optctl.optind;
+
+    if (opt_server) {
+        res = do_server(&ctl);
+    } else if (opt_stream) {
+        ctl.oneline = 1;
+        res = do_stream(argc, argv, &ctl);
+    } else if (argc != 1) {
         warnx("argument missing\n");
-        return 1;
+        res = 0;
+    } else {
+        res = do_separation(stdout, &ctl, argv[0]);
     }
 
-    if (!do_separation(argv[1]))
-        return 1;
+    free(ctl.fields);
+    free(ctl.fieldlen);
+    free(ctl.pairs);
 
-    return 0;
+    return !res;
 }
@@ -34,14 +34,20 @@
 #include "bee_version_parse.h"
 #include "bee_version_output.h"
 #include "bee_tree.h"
+#include "bee_btree.h"
 #include "bee_getopt.h"
+#include "bee_server.h"
+
+#define OPT_SERVER 256
+
+struct my_key {
+    size_t length;
+    unsigned char data[];
+};
 
 void my_free_key(void *key)
 {
-    struct beeversion *v = key;
-
-    free(v->string);
-    free(v);
+    free(key);
 }
 
 void my_free_data(void *data)
@@ -51,7 +57,10 @@ void my_free_data(void *data)
 
 int my_compare_key(void *a, void *b)
 {
-    return compare_beepackages(a, b);
+    struct my_key *ka = a;
+    struct my_key *kb = b;
+
+    return compare_beepackage_keys(ka->data, ka->length, kb->data, kb->length);
 }
 
 int my_compare_data(void *a, void *b)
@@ -67,57 +76,67 @@ void my_print(void *key, void *data)
 void *my_generate_key(const void *data)
 {
     const char *line = data;
-    size_t l;
-    char *s, *p;
-    char *string;
-    struct beeversion *v;
-
-    string = strdup(line);
-
-    if(!string) {
-        perror("calloc(s)");
-        return NULL;
-    }
+    const char *s, *p;
+    char string[LINE_MAX];
+    char parsed[LINE_MAX];
+    struct beeversion v;
+    struct my_key *key;
+    unsigned char buffer[2*LINE_MAX];
+    size_t length;
 
-    s = string;
-    l = strlen(s);
-    p = s+l-1;
+    s = line;
+    p = s+strlen(s)-1;
 
     while (p > s && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
-        *(p--) = 0;
+        p--;
 
     while (*s && (*s == ' ' || *s == '\t'))
         s++;
 
     if(p < s) {
-        free(string);
         errno = EINVAL;
         return NULL;
     }
 
-    v = calloc(1, sizeof(*v));
-    if(!v) {
-        perror("calloc(beeversion)");
-        free(string);
+    length = p-s+1;
+
+    if(length >= sizeof(string)) {
+        errno = EINVAL;
         return NULL;
     }
 
-    if(parse_version(s, v) != 0) {
-        free(v->string);
-        init_version(s, v);
-        v->pkgname = v->string;
+    memcpy(string, s, length);
+    string[length] = 0;
+
+    /* parse without allocating: v points into parsed[] */
+    if(parse_version_buffer(string, &v, parsed, sizeof(parsed)) != 0) {
+        init_version_buffer(string, &v, parsed, sizeof(parsed));
+        v.pkgname = v.string;
+    }
+
+    length = encode_beepackage_key(&v, buffer, sizeof(buffer));
+
+    key = malloc(sizeof(*key) + length);
+    if(!key) {
+        perror("malloc(key)");
+        return NULL;
     }
 
-    free(string);
+    key->length = length;
 
-    return v;
+    if(length <= sizeof(buffer))
+        memcpy(key->data, buffer, length);
+    else
+        encode_beepackage_key(&v, key->data, length);
+
+    return key;
 }
 
 struct bee_tree *init_tree(void)
 {
     struct bee_tree *tree;
 
-    tree = bee_tree_allocate();
+    tree = bee_tree_allocate_pooled();
 
     if(tree == NULL) {
         perror("cannot allocate memory ..");
@@ -134,16 +153,134 @@ struct bee_tree *init_tree(void)
     return tree;
 }
 
+struct bee_btree *init_btree(void)
+{
+    struct bee_btree *tree;
+
+    tree = bee_btree_allocate();
+
+    if(tree == NULL) {
+        perror("cannot allocate memory ..");
+        exit(EXIT_FAILURE);
+    }
+
+    tree->generate_key = &my_generate_key;
+    tree->free_key     = &my_free_key;
+    tree->free_data    = &my_free_data;
+    tree->compare_key  = &my_compare_key;
+    tree->compare_data = &my_compare_data;
+    tree->print        = &my_print;
+
+    return tree;
+}
+
+void sort_tree(char **lines, size_t nlines, int flags)
+{
+    struct bee_tree *tree;
+
+    tree = init_tree();
+
+    bee_tree_set_flags(tree, flags);
+
+    if(bee_tree_build_sorted(tree, (void **)lines, nlines) < 0) {
+        perror("bee_tree_build_sorted");
+        exit(EXIT_FAILURE);
+    }
+
+    bee_tree_print_plain(tree);
+
+    bee_tree_free(tree);
+}
+
+void sort_btree(char **lines, size_t nlines, int flags)
+{
+    struct bee_btree *tree;
+    size_t i;
+
+    tree = init_btree();
+
+    bee_btree_set_flags(tree, flags);
+
+    for(i = 0; i < nlines; i++) {
+        if(bee_btree_insert(tree, lines[i]))
+            continue;
+
+        if(errno != EINVAL && errno != EEXIST) {
+            perror("bee_btree_insert");
+            exit(EXIT_FAILURE);
+        }
+
+        free(lines[i]);
+    }
+
+    bee_btree_print_plain(tree);
+
+    bee_btree_free(tree);
+}
+
+/* flags used for the trees built in server mode */
+static int server_flags;
+
+/* server: sort <package1> [.. <packageN>] */
+static int server_sort(FILE *out, int argc, char *argv[])
+{
+    struct bee_tree *tree;
+    struct bee_subtree *node;
+    char **lines;
+    int i;
+
+    lines = calloc(argc, sizeof(*lines));
+    if(!lines) {
+        perror("calloc(lines)");
+        exit(EXIT_FAILURE);
+    }
+
+    for(i = 0; i < argc; i++) {
+        if(!(lines[i] = strdup(argv[i]))) {
+            perror("strdup(data)");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    tree = init_tree();
+
+    bee_tree_set_flags(tree, server_flags);
+
+    if(bee_tree_build_sorted(tree, (void **)lines, argc) < 0) {
+        perror("bee_tree_build_sorted");
+        exit(EXIT_FAILURE);
+    }
+
+    bee_tree_foreach(tree, node)
+        fprintf(out, "%s\n", (char *)node->data);
+
+    bee_tree_free(tree);
+    free(lines);
+
+    return BEE_SERVER_OK;
+}
+
+int do_server(int flags)
+{
+    struct bee_server_command commands[] = {
+        BEE_SERVER_COMMAND("sort", 1, BEE_SERVER_UNLIMITED, server_sort),
+        BEE_SERVER_COMMAND_END
+    };
+
+    server_flags = flags;
+
+    return bee_server_run("beesort", commands, stdin, stdout);
+}
 
 int main(int argc, char *argv[])
 {
     char line[LINE_MAX];
     char *data;
+    char **lines = NULL;
+    size_t nlines = 0;
+    size_t alines = 0;
     FILE *file;
 
-    struct bee_tree *tree;
-    struct bee_subtree *subtree;
-
     char *filename;
 
     int opt;
@@ -151,10 +288,15 @@ int main(int argc, char *argv[])
     int optind;
 
     int opt_uniq  = 0;
+    int opt_btree = 0;
+    int opt_server = 0;
+    int flags;
 
     struct bee_getopt_ctl optctl;
     struct bee_option options[] = {
         BEE_OPTION_NO_ARG("unique",   'u'),
+        BEE_OPTION_NO_ARG("btree",    'b'),
+        BEE_OPTION(BEE_OPT_LONG("server"), BEE_OPT_VALUE(OPT_SERVER)),
         BEE_OPTION_END
     };
 
@@ -172,6 +314,14 @@ int main(int argc, char *argv[])
             case 'u':
                 opt_uniq++;
                 break;
+
+            case 'b':
+                opt_btree = 1;
+                break;
+
+            case OPT_SERVER:
+                opt_server = 1;
+                break;
         }
     }
 
@@ -179,6 +329,16 @@ int main(int argc, char *argv[])
     argc   = optctl.argc;
     argv   = optctl.argv;
 
+    flags = BEE_TREE_FLAG_COMPARE_DATA_ON_EQUAL_KEY;
+
+    if (opt_uniq == 1)
+        flags |= BEE_TREE_FLAG_UNIQUE_DATA;
+    else if (opt_uniq > 1)
+        flags |= BEE_TREE_FLAG_UNIQUE;
+
+    if(opt_server)
+        return !do_server(flags);
+
     if(argc > optind) {
         filename = argv[optind];
         file     = fopen(filename, "r");
@@ -191,44 +351,34 @@ int main(int argc, char *argv[])
         file = stdin;
     }
 
-    tree = init_tree();
-
-    if (opt_uniq == 1)
-        bee_tree_set_flags(tree, BEE_TREE_FLAG_UNIQUE_DATA);
-    else if (opt_uniq > 1)
-        bee_tree_set_flags(tree, BEE_TREE_FLAG_UNIQUE);
-
-    bee_tree_set_flags(tree, BEE_TREE_FLAG_COMPARE_DATA_ON_EQUAL_KEY);
-
+    /* collect all lines first: sorted input is bulk-loaded in O(n) */
     while(fgets(line, LINE_MAX, file)) {
+        if(nlines == alines) {
+            alines = alines ? 2 * alines : 1024;
+            lines  = realloc(lines, alines * sizeof(*lines));
+            if(!lines) {
+                perror("realloc(lines)");
+                exit(EXIT_FAILURE);
+            }
+        }
+
         data = strdup(line);
         if(!data) {
             perror("strdup(data)");
-            bee_tree_free(tree);
-            fclose(file);
             exit(EXIT_FAILURE);
         }
 
-        subtree = bee_tree_insert(tree, data);
-        if(subtree)
-            continue;
-
-        if(errno == EINVAL)
-            continue;
-
-        if(errno == EEXIST)
-            continue;
-
-        bee_tree_free(tree);
-        fclose(file);
-        exit(EXIT_FAILURE);
+        lines[nlines++] = data;
     }
 
     fclose(file);
 
-    bee_tree_print_plain(tree);
+    if (opt_btree)
+        sort_btree(lines, nlines, flags);
+    else
+        sort_tree(lines, nlines, flags);
 
-    bee_tree_free(tree);
+    free(lines);
 
     return 0;
 }
@@ -31,6 +31,7 @@
 #include "bee_version_parse.h"
 #include "bee_version_compare.h"
 #include "bee_version_output.h"
+#include "bee_server.h"
 
 #define TEST_BITS 3
 #define TYPE_BITS 2
@@ -67,11 +68,34 @@
 #define OPT_VERSION  130
 #define OPT_HELP     131
 #define OPT_FILTER_PKGFULLNAME 132
+#define OPT_FILTER_PKGFULLPKG  133
+#define OPT_FILTER_PKGALLPKG   134
+#define OPT_STDIN              135
+#define OPT_NULL               136
+#define OPT_SERVER             137
 
 #define MODE_TEST   1
 #define MODE_PARSE  2
 
 char *filter_pkgfullname = NULL;
+char *filter_pkgfullpkg  = NULL;
+char *filter_pkgallpkg   = NULL;
+
+char *keyvalue = "PKGNAME=%p\n"
+                 "PKGEXTRANAME=%x\n"
+                 "PKGEXTRANAME_UNDERSCORE=%_x\n"
+                 "PKGEXTRANAME_DASH=%-x\n"
+                 "PKGVERSION=( @v )\n"
+                 "PKGEXTRAVERSION=%e\n"
+                 "PKGEXTRAVERSION_UNDERSCORE=%_e\n"
+                 "PKGEXTRAVERSION_DASH=%-e\n"
+                 "PKGREVISION=%r\n"
+                 "PKGARCH=%a\n"
+                 "PKGFULLNAME=%P\n"
+                 "PKGFULLVERSION=%V\n"
+                 "PKGFULLPKG=%F\n"
+                 "PKGALLPKG=%A\n"
+                 "PKGSUFFIX=%s\n";
 
 int compare_beeversions(struct beeversion *, struct beeversion *);
 char parse_extra(struct beeversion *);
@@ -89,7 +113,9 @@ void print_full_usage(void) {
     
     printf("   test: beeversion <packageA> -{lt|le|gt|ge|eq|ne} <packageB>\n");
     printf(" filter: beeversion [filter-options] -{min|max} <package1> [.. <packageN>]\n");
-    printf("  parse: beeversion [parse-options] <package>\n\n");
+    printf("  parse: beeversion [parse-options] <package>\n");
+    printf("  batch: beeversion --stdin [--null] [parse-options] [filter-options]\n");
+    printf(" server: beeversion --server\n\n");
     
     printf("         package := <pkgfullname>-<pkgfullversion>-<pkgrevision>\n");
     printf("                  | <pkgfullname>-<pkgfullversion>\n");
@@ -106,8 +132,23 @@ void print_full_usage(void) {
     
     printf("   filter-options:\n\n");
 
-    printf("      --filter-pkgfullname=<pkgfullname>\n\n");
-    
+    printf("      --filter-pkgfullname=<pkgfullname>\n");
+    printf("      --filter-pkgfullpkg=<pkgfullpkg>     (batch mode only)\n");
+    printf("      --filter-pkgallpkg=<pkgallpkg>       (batch mode only)\n\n");
+
+    printf("   batch mode reads one package per line from stdin (NUL-separated\n");
+    printf("   with --null) and prints the format for each of them. if filters\n");
+    printf("   are given only packages matching any of them are printed; without\n");
+    printf("   a format the matching input lines are printed as they are.\n\n");
+
+    printf("   server mode answers requests read from stdin until EOF:\n\n");
+    printf("      parse <package> [<format>]\n");
+    printf("      compare <packageA> {lt|le|gt|ge|eq|ne} <packageB>\n");
+    printf("      {min|max} <package1> [.. <packageN>]\n\n");
+    printf("   each response starts with a line '<status> <lines>' followed by\n");
+    printf("   <lines> lines of output. status is 0 on success (or if the\n");
+    printf("   test holds), 1 if the test fails and 2 on errors.\n\n");
+
 }
 
 int parse_argument(char* text, struct beeversion *versionsnummer)
@@ -121,22 +162,131 @@ int parse_argument(char* text, struct beeversion *versionsnummer)
     return(1);
 }
 
-static int compare_beepackages_gen(const void *a, const void *b) {
-    return((int)compare_beepackages((struct beeversion *)a, (struct beeversion *)b));
+struct sortkey {
+    unsigned char     *key;
+    size_t             length;
+    struct beeversion *v;
+};
+
+static int compare_sortkeys(const void *a, const void *b) {
+    const struct sortkey *ka = a;
+    const struct sortkey *kb = b;
+
+    return(compare_beepackage_keys(ka->key, ka->length, kb->key, kb->length));
 }
 
-int do_test(int argc, char *argv[], char test) {
+/*
+ * RETURN: 1 if test t holds for a and b, 0 if not, -1 on syntax errors
+ */
+static int test_versions(char *pa, char *pb, char t) {
+    struct beeversion a, b;
+    int ret;
+
+    if(!parse_argument(pa, &a)) {
+        free(a.string);
+        return(-1);
+    }
+
+    if(!parse_argument(pb, &b)) {
+        free(a.string);
+        free(b.string);
+        return(-1);
+    }
+
+    ret = compare_beeversions(&a, &b);
+
+    free(a.string);
+    free(b.string);
+
+    switch(t) {
+        case T_LESS_THAN:
+            return(ret < 0);
+        case T_LESS_EQUAL:
+            return(ret <= 0);
+        case T_GREATER_THAN:
+            return(ret > 0);
+        case T_GREATER_EQUAL:
+            return(ret >= 0);
+        case T_EQUAL:
+            return(ret == 0);
+        case T_NOT_EQUAL:
+            return(ret != 0);
+    }
+    fprintf(stderr, "beeversion: YOU HIT A BUG #004\n");
+
+    return(-1);
+}
+
+/* print the max or min version of each package in argv to out */
+static int print_extremes(FILE *out, int argc, char *argv[], char t) {
     int i;
-    
-    struct beeversion v[2];
+
     struct beeversion *a, *b, *va;
-    
+    struct sortkey *sk;
+
+    if(!(va = calloc(sizeof(struct beeversion), argc))) {
+        perror("va=calloc()");
+        exit(255);
+    }
+
+    if(!(sk = calloc(sizeof(struct sortkey), argc))) {
+        perror("sk=calloc()");
+        exit(255);
+    }
+
+    for(i=0;i<argc;i++) {
+        if(!parse_argument(argv[i], va+i)) {
+            free(va[i].string);
+            while(i--) {
+                free(va[i].string);
+                free(sk[i].key);
+            }
+            free(sk);
+            free(va);
+            return(0);
+        }
+
+        sk[i].v      = va+i;
+        sk[i].length = encode_beepackage_key(va+i, NULL, 0);
+
+        if(!(sk[i].key = malloc(sk[i].length))) {
+            perror("malloc(key)");
+            exit(255);
+        }
+
+        encode_beepackage_key(va+i, sk[i].key, sk[i].length);
+    }
+
+    qsort(sk, argc, sizeof(struct sortkey), compare_sortkeys);
+
+    for(a=sk[0].v,i=1;i<argc;i++) {
+        b=sk[i].v;
+
+        /* a != b */
+        if(compare_beepackage_names(a, b)) {
+            fprint_format(out, "%A\n", a, filter_pkgfullname);
+            a = b;
+        }
+
+        if(t == T_MAX)
+           a = b;
+    }
+    fprint_format(out, "%A\n", a, filter_pkgfullname);
+
+    for(i=0;i<argc;i++) {
+        free(va[i].string);
+        free(sk[i].key);
+    }
+
+    free(sk);
+    free(va);
+    return(1);
+}
+
+int do_test(int argc, char *argv[], char test) {
     int ret;
     char t;
     
-    a = &v[0];
-    b = &v[1];
-    
     t = (test & TEST_MASK);
     
     if((test & TEST_TYPE_MASK) == TEST_WITH_2_ARGS) {
@@ -145,31 +295,9 @@ int do_test(int argc, char *argv[], char test) {
             return(255);
         }
         
-        for(i=0; i<2; i++) {
-            if(!parse_argument(argv[i], &v[i]))
-               return(0);
-        }
-        
-        ret = compare_beeversions(a, b);
-
-        free(a->string);
-        free(b->string);
-
-        switch(t) {
-            case T_LESS_THAN:
-                return(ret < 0);
-            case T_LESS_EQUAL:
-                return(ret <= 0);
-            case T_GREATER_THAN:
-                return(ret > 0);
-            case T_GREATER_EQUAL:
-                return(ret >= 0);
-            case T_EQUAL:
-                return(ret == 0);
-            case T_NOT_EQUAL:
-                return(ret != 0);
-        }
-        fprintf(stderr, "beeversion: YOU HIT A BUG #004\n");
+        ret = test_versions(argv[0], argv[1], t);
+
+        return(ret > 0);
     }
     
     /* min / max */
@@ -180,38 +308,7 @@ int do_test(int argc, char *argv[], char test) {
             return(255);
         }
         
-        if(!(va = calloc(sizeof(struct beeversion), argc))) {
-            perror("va=calloc()");
-            exit(255);
-        }
-        
-        for(i=0;i<argc;i++) {
-            if(!parse_argument(argv[i], va+i))
-                return(0);
-        }
-        
-        qsort(va, argc, sizeof(struct beeversion), compare_beepackages_gen);
-        
-        for(a=va,i=1;i<argc;i++) {
-            b=va+i;
-            
-            /* a != b */
-            if(compare_beepackage_names(a, b)) {
-                print_format("%A\n", a, filter_pkgfullname);
-                a = b;
-            }
-            
-            if(t == T_MAX) 
-               a = b;
-        }
-        print_format("%A\n", a, filter_pkgfullname);
-
-        for(i=0;i<argc;i++) {
-            free(va[i].string);
-        }
-
-        free(va);
-        return(1);
+        return(print_extremes(stdout, argc, argv, t));
     }
     
     fprintf(stderr, "beeversion: YOU HIT A BUG #006\n");
@@ -237,6 +334,200 @@ int do_parse(int argc, char *argv[], char *format) {
     return(1);
 }
 
+/*
+ * match one component of a package string as print_format() prints it:
+ * empty components are skipped, others are prefixed by sep (if any).
+ *
+ * RETURN: pointer behind the component or NULL on mismatch
+ */
+static char *match_component(char *s, char sep, char *component)
+{
+    size_t len;
+
+    if(!s || !*component)
+        return(s);
+
+    if(sep && *s++ != sep)
+        return(NULL);
+
+    len = strlen(component);
+
+    if(strncmp(s, component, len))
+        return(NULL);
+
+    return(s+len);
+}
+
+static int match_pkgfullname(struct beeversion *v, char *name)
+{
+    char *s;
+
+    s = match_component(name, 0, v->pkgname);
+    s = match_component(s, '_', v->subname);
+
+    return(s && !*s);
+}
+
+static int match_pkgfullpkg(struct beeversion *v, char *name, int with_arch)
+{
+    char *s;
+
+    s = match_component(name, 0, v->pkgname);
+    s = match_component(s, '_', v->subname);
+    s = match_component(s, '-', v->version);
+    s = match_component(s, '_', v->extraversion);
+    s = match_component(s, '-', v->pkgrevision);
+
+    if(with_arch)
+        s = match_component(s, '.', v->arch);
+
+    return(s && !*s);
+}
+
+static int match_filters(struct beeversion *v)
+{
+    if(!filter_pkgfullname && !filter_pkgfullpkg && !filter_pkgallpkg)
+        return(1);
+
+    if(filter_pkgfullname && match_pkgfullname(v, filter_pkgfullname))
+        return(1);
+
+    if(filter_pkgfullpkg && match_pkgfullpkg(v, filter_pkgfullpkg, 0))
+        return(1);
+
+    if(filter_pkgallpkg && match_pkgfullpkg(v, filter_pkgallpkg, 1))
+        return(1);
+
+    return(0);
+}
+
+/*
+ * batch mode: parse every package read from stdin with a single process
+ * instead of forking beeversion once per package in shell loops.
+ * lines that fail to parse are reported and skipped.
+ *
+ * RETURN: 1 if all lines could be parsed, 0 otherwise
+ */
+int do_stdin(char *format, char delimiter) {
+    struct beeversion v;
+    char   *line   = NULL;
+    size_t  size   = 0;
+    char   *buffer = NULL;
+    size_t  bsize  = 0;
+    ssize_t len;
+    int     p;
+    int     ok = 1;
+
+    while((len = getdelim(&line, &size, delimiter, stdin)) != -1) {
+        if(len && line[len-1] == delimiter)
+            line[--len] = 0;
+
+        if(!len)
+            continue;
+
+        if(bsize < size) {
+            free(buffer);
+            bsize = size;
+            if(!(buffer = malloc(bsize))) {
+                perror("malloc(buffer)");
+                exit(255);
+            }
+        }
+
+        if((p = parse_version_buffer(line, &v, buffer, bsize))) {
+            fprintf(stderr, "beeversion: syntax error at position %d in '%s'\n", p, line);
+            ok = 0;
+            continue;
+        }
+
+        if(!match_filters(&v))
+            continue;
+
+        if(format) {
+            print_format(format, &v, NULL);
+            continue;
+        }
+
+        fputs(line, stdout);
+        putchar(delimiter);
+    }
+
+    if(ferror(stdin)) {
+        perror("beeversion: stdin");
+        ok = 0;
+    }
+
+    free(buffer);
+    free(line);
+
+    return(ok);
+}
+
+/* server: parse <package> [<format>] */
+static int server_parse(FILE *out, int argc, char *argv[]) {
+    struct beeversion v;
+
+    if(!parse_argument(argv[0], &v)) {
+        free(v.string);
+        return(BEE_SERVER_ERROR);
+    }
+
+    fprint_format(out, (argc > 1) ? argv[1] : keyvalue, &v, NULL);
+
+    free(v.string);
+
+    return(BEE_SERVER_OK);
+}
+
+/* server: compare <packageA> lt|le|gt|ge|eq|ne <packageB> */
+static int server_compare(FILE *out, int argc, char *argv[]) {
+    char *tests[] = { "lt", "le", "gt", "ge", "eq", "ne", NULL };
+    char *op;
+    int t;
+    int ret;
+
+    for(op = argv[1]; *op == '-'; op++)
+        ;
+
+    for(t = 0; tests[t]; t++) {
+        if(!strcmp(op, tests[t]))
+            break;
+    }
+
+    if(!tests[t]) {
+        fprintf(stderr, "beeversion: unknown test '%s'\n", argv[1]);
+        return(BEE_SERVER_ERROR);
+    }
+
+    ret = test_versions(argv[0], argv[2], t);
+
+    if(ret < 0)
+        return(BEE_SERVER_ERROR);
+
+    return(ret ? BEE_SERVER_OK : BEE_SERVER_FALSE);
+}
+
+/* server: max|min <package1> [.. <packageN>] */
+static int server_max(FILE *out, int argc, char *argv[]) {
+    return(print_extremes(out, argc, argv, T_MAX) ? BEE_SERVER_OK : BEE_SERVER_ERROR);
+}
+
+static int server_min(FILE *out, int argc, char *argv[]) {
+    return(print_extremes(out, argc, argv, T_MIN) ? BEE_SERVER_OK : BEE_SERVER_ERROR);
+}
+
+int do_server(void) {
+    struct bee_server_command commands[] = {
+        BEE_SERVER_COMMAND("parse",   1, 2, server_parse),
+        BEE_SERVER_COMMAND("compare", 3, 3, server_compare),
+        BEE_SERVER_COMMAND("max",     1, BEE_SERVER_UNLIMITED, server_max),
+        BEE_SERVER_COMMAND("min",     1, BEE_SERVER_UNLIMITED, server_min),
+        BEE_SERVER_COMMAND_END
+    };
+
+    return(bee_server_run("beeversion", commands, stdin, stdout));
+}
+
 int main(int argc, char *argv[])
 {
     int option_index = 0;
@@ -247,24 +538,10 @@ int main(int argc, char *argv[])
     int  test_index   = 0;
     int  build_format = 0;
     char mode         = 0;
+    int  batch        = 0;
+    int  server       = 0;
+    char delimiter    = '\n';
     
-    char *keyvalue;
-    
-    keyvalue = "PKGNAME=%p\n"
-               "PKGEXTRANAME=%x\n"
-               "PKGEXTRANAME_UNDERSCORE=%_x\n"
-               "PKGEXTRANAME_DASH=%-x\n"
-               "PKGVERSION=( @v )\n"
-               "PKGEXTRAVERSION=%e\n"
-               "PKGEXTRAVERSION_UNDERSCORE=%_e\n"
-               "PKGEXTRAVERSION_DASH=%-e\n"
-               "PKGREVISION=%r\n"
-               "PKGARCH=%a\n"
-               "PKGFULLNAME=%P\n"
-               "PKGFULLVERSION=%V\n"
-               "PKGFULLPKG=%F\n"
-               "PKGALLPKG=%A\n"
-               "PKGSUFFIX=%s\n";
 
     struct option long_options[] = {
         /* tests  with 2 args */
@@ -309,6 +586,15 @@ int main(int argc, char *argv[])
         {"pkgsubname",      no_argument, 0, 'x'},
         
         {"filter-pkgfullname", required_argument, 0, OPT_FILTER_PKGFULLNAME},
+        {"filter-pkgfullpkg",  required_argument, 0, OPT_FILTER_PKGFULLPKG},
+        {"filter-pkgallpkg",   required_argument, 0, OPT_FILTER_PKGALLPKG},
+
+        /* batch mode */
+        {"stdin",       no_argument, 0, OPT_STDIN},
+        {"null",        no_argument, 0, OPT_NULL},
+
+        /* coprocess mode */
+        {"server",      no_argument, 0, OPT_SERVER},
         
         {"version",     no_argument, 0, OPT_VERSION},
         {"help",        no_argument, 0, OPT_HELP},
@@ -339,6 +625,31 @@ int main(int argc, char *argv[])
             filter_pkgfullname = optarg;
             continue;
         }
+
+        if(c == OPT_FILTER_PKGFULLPKG) {
+            filter_pkgfullpkg = optarg;
+            continue;
+        }
+
+        if(c == OPT_FILTER_PKGALLPKG) {
+            filter_pkgallpkg = optarg;
+            continue;
+        }
+
+        if(c == OPT_STDIN) {
+            batch = 1;
+            continue;
+        }
+
+        if(c == OPT_NULL) {
+            delimiter = '\0';
+            continue;
+        }
+
+        if(c == OPT_SERVER) {
+            server = 1;
+            continue;
+        }
         
         if(mode && mode == MODE_TEST) {
             fprintf(stderr, "beeversion: skipping parse-option --%s since already running in test mode\n",
@@ -411,6 +722,32 @@ int main(int argc, char *argv[])
     if(build_format)
         format[build_format++] = '\n';
     
+    if(server) {
+        if(mode || batch || argc > optind) {
+            fprintf(stderr, "usage: beeversion --server [--filter-pkgfullname=<pkgfullname>]\n");
+            return(255);
+        }
+
+        return(!do_server());
+    }
+
+    if(batch) {
+        if(mode == MODE_TEST) {
+            fprintf(stderr, "beeversion: --stdin can't be used with test-options\n");
+            return(255);
+        }
+
+        if(argc > optind) {
+            fprintf(stderr, "usage: beeversion --stdin [options] < <packagelist>\n");
+            return(255);
+        }
+
+        if(!format && !filter_pkgfullname && !filter_pkgfullpkg && !filter_pkgallpkg)
+            format = keyvalue;
+
+        return(!do_stdin(format, delimiter));
+    }
+
     if(mode == MODE_TEST) 
         return(!do_test(argc-optind, argv+optind, test_to_do));
     
@@ -0,0 +1,134 @@
+/*
+** bench-bee-btree - bee_tree against bee_btree on package names
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "bee_tree.h"
+#include "bee_btree.h"
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* package names in random order */
+static char **generate(size_t n)
+{
+    char **names;
+    size_t i;
+
+    names = calloc(n, sizeof(*names));
+    assert(names);
+
+    srand(n);
+
+    for (i = 0; i < n; i++) {
+        names[i] = malloc(64);
+        assert(names[i]);
+        sprintf(names[i], "pkg%d-%d.%d.%d-%d.x86_64",
+                rand(), rand() % 10, rand() % 30, rand() % 100, rand() % 3);
+    }
+
+    return names;
+}
+
+static void bench_tree(char **names, size_t n, double *insert, double *search)
+{
+    struct bee_tree *tree;
+    size_t i;
+
+    tree = bee_tree_allocate_pooled();
+    assert(tree);
+
+    *insert = now();
+    for (i = 0; i < n; i++)
+        bee_tree_insert(tree, names[i]);
+    *insert = now() - *insert;
+
+    *search = now();
+    for (i = 0; i < n; i++) {
+        if (!bee_tree_search(tree, names[i]))
+            abort();
+    }
+    *search = now() - *search;
+
+    bee_tree_free(tree);
+}
+
+static void bench_btree(char **names, size_t n, double *insert, double *search)
+{
+    struct bee_btree *tree;
+    size_t i;
+
+    tree = bee_btree_allocate();
+    assert(tree);
+
+    *insert = now();
+    for (i = 0; i < n; i++)
+        bee_btree_insert(tree, names[i]);
+    *insert = now() - *insert;
+
+    *search = now();
+    for (i = 0; i < n; i++) {
+        if (!bee_btree_search(tree, names[i]))
+            abort();
+    }
+    *search = now() - *search;
+
+    bee_btree_free(tree);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sizes[] = { 10000, 100000, 1000000 };
+    double ti, ts, bi, bs;
+    size_t n, i, s;
+    char **names;
+
+    printf("package names      insert avl   insert btree   search avl   search btree\n");
+
+    for (s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+        n     = sizes[s];
+        names = generate(n);
+
+        bench_tree(names, n, &ti, &ts);
+        bench_btree(names, n, &bi, &bs);
+
+        printf("  %8zu %14.3fs %13.3fs %11.3fs %13.3fs\n", n, ti, bi, ts, bs);
+
+        for (i = 0; i < n; i++)
+            free(names[i]);
+        free(names);
+    }
+
+    return EXIT_SUCCESS;
+}
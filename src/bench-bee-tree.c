@@ -0,0 +1,147 @@
+/*
+** bench-bee-tree - bee_tree_insert() against bee_tree_build_sorted()
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "bee_tree.h"
+
+enum order { SORTED, REVERSED, RANDOM };
+
+static const char *order_name[] = { "sorted", "reversed", "random" };
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* package names in the given order */
+static char **generate(size_t n, enum order order)
+{
+    char **names, *tmp;
+    size_t i, j;
+
+    names = calloc(n, sizeof(*names));
+    assert(names);
+
+    srand(1);
+
+    for (i = 0; i < n; i++) {
+        names[i] = malloc(64);
+        assert(names[i]);
+        sprintf(names[i], "pkg%zu-%d.%d.%d-%d.x86_64",
+                i, rand() % 10, rand() % 30, rand() % 100, rand() % 3);
+    }
+
+    qsort(names, n, sizeof(*names), compare_strings);
+
+    if (order == REVERSED) {
+        for (i = 0, j = n - 1; i < j; i++, j--) {
+            tmp = names[i]; names[i] = names[j]; names[j] = tmp;
+        }
+    } else if (order == RANDOM) {
+        for (i = n - 1; i > 0; i--) {
+            j = rand() % (i + 1);
+            tmp = names[i]; names[i] = names[j]; names[j] = tmp;
+        }
+    }
+
+    return names;
+}
+
+static double bench_insert(char **names, size_t n)
+{
+    struct bee_tree *tree;
+    double t;
+    size_t i;
+
+    tree = bee_tree_allocate_pooled();
+    assert(tree);
+
+    t = now();
+    for (i = 0; i < n; i++)
+        bee_tree_insert(tree, names[i]);
+    t = now() - t;
+
+    bee_tree_free(tree);
+
+    return t;
+}
+
+static double bench_build(char **names, size_t n)
+{
+    struct bee_tree *tree;
+    double t;
+
+    tree = bee_tree_allocate_pooled();
+    assert(tree);
+
+    t = now();
+    if (bee_tree_build_sorted(tree, (void **)names, n) != (ssize_t)n) {
+        perror("bee_tree_build_sorted");
+        exit(EXIT_FAILURE);
+    }
+    t = now() - t;
+
+    bee_tree_free(tree);
+
+    return t;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = 200000, i;
+    enum order order;
+    char **names;
+
+    if (argc > 1)
+        n = strtoul(argv[1], NULL, 10);
+
+    printf("%zu package names   insert loop   build_sorted\n", n);
+
+    for (order = SORTED; order <= RANDOM; order++) {
+        names = generate(n, order);
+
+        printf("  %-18s %10.3fs %13.3fs\n", order_name[order],
+               bench_insert(names, n), bench_build(names, n));
+
+        for (i = 0; i < n; i++)
+            free(names[i]);
+        free(names);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,347 @@
+/*
+** bench-bloom - false positives and lookup speed of the per package Bloom filters
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bee_bloom.h"
+#include "bee_inventory.h"
+
+/* synthetic packages and their paths */
+#define NPKGS     2000
+#define MIN_PATHS 50
+#define MAX_PATHS 800
+
+#define LOOKUP_ROUNDS 20
+
+struct pkg {
+    char   **paths;
+    size_t npaths;
+};
+
+struct result {
+    unsigned long filters;
+    unsigned long members;
+    unsigned long negatives;
+    unsigned long false_negatives;
+    unsigned long false_positives;
+    double        open;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(struct result *r)
+{
+    double k = BEE_BLOOM_HASHES, bits = BEE_BLOOM_BITS_PER_KEY;
+
+    printf("  filters                %10lu\n", r->filters);
+    printf("  members tested         %10lu\n", r->members);
+    printf("  false negatives        %10lu\n", r->false_negatives);
+    printf("  non-members tested     %10lu\n", r->negatives);
+    printf("  false positive rate    %9.2f%%  (theory %.2f%%)\n",
+           r->negatives ? 100.0 * r->false_positives / r->negatives : 0.0,
+           100.0 * pow(1 - exp(-k / bits), k));
+    printf("  open+map of a filter   %9.1fus\n", r->filters ? 1e6 * r->open / r->filters : 0.0);
+}
+
+/* lookups of keys[0..n) against one filter */
+static void throughput(struct bee_bloom *bf, char **keys, size_t *lens, size_t n)
+{
+    unsigned long lookups = 0, accepted = 0;
+    double t;
+    size_t i;
+    int round;
+
+    t = now();
+    for (round = 0; round < LOOKUP_ROUNDS; round++) {
+        for (i = 0; i < n; i++)
+            accepted += bee_bloom_test(bf, keys[i], lens[i]);
+        lookups += n;
+    }
+    t = now() - t;
+
+    printf("  lookups                %10lu in %.3fs = %.1fM/s (%lu accepted)\n",
+           lookups, t, lookups / t / 1e6, accepted);
+}
+
+/*
+ * synthetic packages with distinct paths: each filter is tested against
+ * its own paths and the paths of the next package
+ */
+static int bench_synthetic(void)
+{
+    struct pkg *pkgs;
+    struct bee_bloom bf;
+    struct result r;
+    char *tmpdir, *dir, *file, **keys;
+    size_t i, j, n, nkeys = 0, *lens;
+    double t;
+
+    memset(&r, 0, sizeof(r));
+
+    tmpdir = getenv("TMPDIR");
+    if (!tmpdir || !*tmpdir)
+        tmpdir = "/tmp";
+
+    if (asprintf(&dir, "%s/bench-bloom.XXXXXX", tmpdir) < 0 || !mkdtemp(dir)) {
+        perror("bench-bloom: mkdtemp");
+        return 0;
+    }
+
+    pkgs = calloc(NPKGS, sizeof(*pkgs));
+    assert(pkgs);
+
+    srand(1);
+
+    for (i = 0; i < NPKGS; i++) {
+        n = MIN_PATHS + rand() % (MAX_PATHS - MIN_PATHS + 1);
+        pkgs[i].paths  = calloc(n, sizeof(char *));
+        pkgs[i].npaths = n;
+        assert(pkgs[i].paths);
+
+        for (j = 0; j < n; j++) {
+            if (asprintf(&pkgs[i].paths[j], "/usr/share/pkg%zu/dir%d/file%zu",
+                         i, rand() % 20, j) < 0) {
+                perror("asprintf");
+                return 0;
+            }
+        }
+        nkeys += n;
+    }
+
+    for (i = 0; i < NPKGS; i++) {
+        if (!bee_bloom_init(&bf, pkgs[i].npaths)) {
+            perror("bee_bloom_init");
+            return 0;
+        }
+
+        for (j = 0; j < pkgs[i].npaths; j++)
+            bee_bloom_add(&bf, pkgs[i].paths[j], strlen(pkgs[i].paths[j]));
+
+        if (asprintf(&file, "%s/pkg%zu.bf", dir, i) < 0) {
+            perror("asprintf");
+            return 0;
+        }
+
+        if (!bee_bloom_write(&bf, file, 0)) {
+            fprintf(stderr, "bench-bloom: %s: %m\n", file);
+            return 0;
+        }
+        bee_bloom_free(&bf);
+
+        t = now();
+        if (!bee_bloom_open(&bf, file)) {
+            fprintf(stderr, "bench-bloom: %s: %m\n", file);
+            return 0;
+        }
+        r.open += now() - t;
+        r.filters++;
+
+        for (j = 0; j < pkgs[i].npaths; j++) {
+            r.members++;
+            if (!bee_bloom_test(&bf, pkgs[i].paths[j], strlen(pkgs[i].paths[j])))
+                r.false_negatives++;
+        }
+
+        n = (i + 1) % NPKGS;
+        for (j = 0; j < pkgs[n].npaths; j++) {
+            r.negatives++;
+            r.false_positives += bee_bloom_test(&bf, pkgs[n].paths[j], strlen(pkgs[n].paths[j]));
+        }
+
+        bee_bloom_free(&bf);
+        unlink(file);
+        free(file);
+    }
+
+    rmdir(dir);
+    free(dir);
+
+    printf("%d synthetic packages with %d to %d paths\n", NPKGS, MIN_PATHS, MAX_PATHS);
+    report(&r);
+
+    keys = malloc(nkeys * sizeof(*keys));
+    lens = malloc(nkeys * sizeof(*lens));
+    assert(keys && lens);
+
+    for (i = 0, n = 0; i < NPKGS; i++) {
+        for (j = 0; j < pkgs[i].npaths; j++, n++) {
+            keys[n] = pkgs[i].paths[j];
+            lens[n] = strlen(keys[n]);
+        }
+    }
+
+    bee_bloom_init(&bf, pkgs[0].npaths);
+    for (j = 0; j < pkgs[0].npaths; j++)
+        bee_bloom_add(&bf, pkgs[0].paths[j], lens[j]);
+
+    throughput(&bf, keys, lens, nkeys);
+
+    bee_bloom_free(&bf);
+    free(keys);
+    free(lens);
+
+    for (i = 0; i < NPKGS; i++) {
+        for (j = 0; j < pkgs[i].npaths; j++)
+            free(pkgs[i].paths[j]);
+        free(pkgs[i].paths);
+    }
+    free(pkgs);
+
+    return r.false_negatives == 0;
+}
+
+/*
+ * the .bf files of a bee-cache directory: every step-th distinct path
+ * of the INVENTORY.idx is tested against every filter, the index tells
+ * whether the package owns it
+ */
+static int bench_cache(char *cachedir, unsigned long step)
+{
+    struct bee_inventory inv;
+    struct bee_inventory_path *path;
+    struct bee_bloom bf;
+    struct result r;
+    char *inventory, *index, *file, *pkg, *name, **keys;
+    uint64_t i, p;
+    uint32_t o;
+    size_t *lens;
+    double t;
+    int accepted, member;
+
+    memset(&r, 0, sizeof(r));
+
+    if (asprintf(&inventory, "%s/INVENTORY", cachedir) < 0
+        || asprintf(&index, "%s/INVENTORY.idx", cachedir) < 0) {
+        perror("asprintf");
+        return 0;
+    }
+
+    if (!bee_inventory_open(&inv, inventory, index))
+        return 0;
+
+    for (i = 0; i < inv.header->npkgs; i++) {
+        pkg = BEE_INVENTORY_STRING(&inv, inv.pkgs[i].name);
+
+        if (asprintf(&file, "%s/%s.bf", cachedir, pkg) < 0) {
+            perror("asprintf");
+            return 0;
+        }
+
+        t = now();
+        if (!bee_bloom_open(&bf, file)) {
+            free(file);
+            continue;
+        }
+        r.open += now() - t;
+        r.filters++;
+
+        for (p = i % step; p < inv.header->npaths; p += step) {
+            path = &inv.paths[p];
+            name = inv.pathnames + path->pathname;
+
+            accepted = bee_bloom_test(&bf, name, path->length);
+
+            member = 0;
+            for (o = path->first; o < path->first + path->count; o++) {
+                if (inv.records[inv.owners[o]].pkg == i)
+                    member = 1;
+            }
+
+            if (member) {
+                r.members++;
+                if (!accepted) {
+                    fprintf(stderr, "bench-bloom: false negative: %s %s\n", pkg, name);
+                    r.false_negatives++;
+                }
+            } else {
+                r.negatives++;
+                r.false_positives += accepted;
+            }
+        }
+
+        bee_bloom_free(&bf);
+        free(file);
+    }
+
+    printf("%s: %lu packages, every %lu. of %lu paths\n", cachedir,
+           (unsigned long)inv.header->npkgs, step, (unsigned long)inv.header->npaths);
+    report(&r);
+
+    /* all distinct paths against the filter of the first package */
+    if (inv.header->npkgs
+        && asprintf(&file, "%s/%s.bf", cachedir,
+                    BEE_INVENTORY_STRING(&inv, inv.pkgs[0].name)) >= 0) {
+        if (bee_bloom_open(&bf, file)) {
+            keys = malloc(inv.header->npaths * sizeof(*keys));
+            lens = malloc(inv.header->npaths * sizeof(*lens));
+            assert(keys && lens);
+
+            for (p = 0; p < inv.header->npaths; p++) {
+                keys[p] = inv.pathnames + inv.paths[p].pathname;
+                lens[p] = inv.paths[p].length;
+            }
+
+            throughput(&bf, keys, lens, inv.header->npaths);
+
+            free(keys);
+            free(lens);
+            bee_bloom_free(&bf);
+        }
+        free(file);
+    }
+
+    bee_inventory_close(&inv);
+    free(inventory);
+    free(index);
+
+    return r.false_negatives == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int ok;
+
+    if (argc > 1)
+        ok = bench_cache(argv[1], argc > 2 ? strtoul(argv[2], NULL, 10) : 200);
+    else
+        ok = bench_synthetic();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
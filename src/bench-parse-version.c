@@ -0,0 +1,127 @@
+/*
+** bench-parse-version - time parsing package names with and without allocations
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* link with -Wl,--wrap=uname,--wrap=strdup to count the calls */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <sys/utsname.h>
+
+#include "bee_version.h"
+#include "bee_version_parse.h"
+
+static unsigned long nuname, nstrdup;
+
+int __real_uname(struct utsname *buf);
+char *__real_strdup(const char *s);
+
+int __wrap_uname(struct utsname *buf)
+{
+    nuname++;
+    return __real_uname(buf);
+}
+
+char *__wrap_strdup(const char *s)
+{
+    nstrdup++;
+    return __real_strdup(s);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* architecture suffixed package names */
+static char **generate(size_t n)
+{
+    char *arch[] = { "x86_64", "i686", "noarch" };
+    char **names;
+    size_t i;
+
+    names = calloc(n, sizeof(*names));
+    assert(names);
+
+    srand(1);
+
+    for (i = 0; i < n; i++) {
+        names[i] = malloc(64);
+        assert(names[i]);
+        sprintf(names[i], "pkg%zu-%d.%d.%d-%d.%s", i, rand() % 10, rand() % 30,
+                rand() % 100, rand() % 3, arch[rand() % 3]);
+    }
+
+    return names;
+}
+
+static void report(const char *name, double t)
+{
+    printf("  %-24s %8.3fs %10lu %10lu\n", name, t, nuname, nstrdup);
+    nuname = nstrdup = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct beeversion v;
+    char buffer[64];
+    size_t n = 1000000, i;
+    char **names;
+    double t;
+
+    if (argc > 1)
+        n = strtoul(argv[1], NULL, 10);
+
+    names = generate(n);
+
+    printf("%zu package names           time      uname     strdup\n", n);
+
+    t = now();
+    for (i = 0; i < n; i++) {
+        if (parse_version(names[i], &v) == 0)
+            assert(v.arch);
+        free(v.string);
+    }
+    report("parse_version()", now() - t);
+
+    t = now();
+    for (i = 0; i < n; i++) {
+        if (parse_version_buffer(names[i], &v, buffer, sizeof(buffer)) == 0)
+            assert(v.arch);
+    }
+    report("parse_version_buffer()", now() - t);
+
+    for (i = 0; i < n; i++)
+        free(names[i]);
+    free(names);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/*
+** test-bee-tree - check that AVL retracing does O(1) work per insert
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* needs bee_tree.c compiled with -DBEE_TREE_STATS */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "bee_tree.h"
+
+/* amortized node updates per insert must stay below this for any n */
+#define MAX_UPDATES_PER_INSERT 6.0
+
+/* a single or a double rotation */
+#define MAX_ROTATIONS_PER_INSERT 2
+
+enum order { ASCENDING, DESCENDING, RANDOM };
+
+static const char *order_name[] = { "ascending", "descending", "random" };
+
+/* RETURN: height of node or -1 if the subtree is no valid AVL tree */
+static int check_subtree(struct bee_subtree *node, struct bee_subtree *parent)
+{
+    int l, r;
+
+    if (!node)
+        return 0;
+
+    if (node->parent != parent)
+        return -1;
+
+    if (node->left && strcmp(node->left->key, node->key) > 0)
+        return -1;
+
+    if (node->right && strcmp(node->right->key, node->key) < 0)
+        return -1;
+
+    l = check_subtree(node->left, node);
+    r = check_subtree(node->right, node);
+
+    if (l < 0 || r < 0 || l - r > 1 || r - l > 1)
+        return -1;
+
+    if (node->height != 1 + BEE_TREE_MAX(l, r) || node->balance_factor != l - r)
+        return -1;
+
+    return node->height;
+}
+
+static int run(size_t n, enum order order)
+{
+    struct bee_tree *tree;
+    char **keys;
+    unsigned long updates, rotations, maxrot = 0;
+    size_t i, j;
+    char *tmp;
+    double avg;
+    int ok;
+
+    keys = calloc(n, sizeof(*keys));
+    assert(keys);
+
+    for (i = 0; i < n; i++) {
+        keys[i] = malloc(16);
+        assert(keys[i]);
+        sprintf(keys[i], "%09zu", order == DESCENDING ? n - i : i);
+    }
+
+    if (order == RANDOM) {
+        srand(n);
+        for (i = n - 1; i > 0; i--) {
+            j = rand() % (i + 1);
+            tmp = keys[i]; keys[i] = keys[j]; keys[j] = tmp;
+        }
+    }
+
+    tree = bee_tree_allocate_pooled();
+    assert(tree);
+
+    updates = bee_tree_stats.node_updates;
+
+    for (i = 0; i < n; i++) {
+        rotations = bee_tree_stats.rotations;
+        bee_tree_insert(tree, keys[i]);
+        if (bee_tree_stats.rotations - rotations > maxrot)
+            maxrot = bee_tree_stats.rotations - rotations;
+    }
+
+    avg = (double)(bee_tree_stats.node_updates - updates) / n;
+    ok  = check_subtree(tree->root, NULL) >= 0
+          && avg <= MAX_UPDATES_PER_INSERT && maxrot <= MAX_ROTATIONS_PER_INSERT;
+
+    printf("%-4s %8zu %-10s  %5.2f updates/insert  max %lu rotations/insert\n",
+           ok ? "ok" : "FAIL", n, order_name[order], avg, maxrot);
+
+    bee_tree_free(tree);
+
+    for (i = 0; i < n; i++)
+        free(keys[i]);
+    free(keys);
+
+    return ok;
+}
+
+static size_t freed;
+
+static void count_free_data(void *data)
+{
+    freed++;
+    free(data);
+}
+
+/* blank elements have no key like blank lines in beesort */
+static void *generate_blank_key(const void *data)
+{
+    if (*(const char *)data == ' ') {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    return strdup(data);
+}
+
+/* bee_tree_build_sorted() drops elements without key, maybe all of them */
+static int run_rejected(void)
+{
+    char *blank[] = { " ", "  ", " \t" };
+    char *mixed[] = { " ", "a", " ", "b", "c", " " };
+    struct {
+        char   **data;
+        size_t n;
+        size_t keys;
+    } cases[] = {
+        { blank, 3, 0 },
+        { mixed, 6, 3 },
+    };
+    struct bee_tree *tree;
+    void *data[6];
+    size_t c, i;
+    ssize_t n;
+    int ok = 1;
+
+    for (c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+        tree = bee_tree_allocate_pooled();
+        assert(tree);
+
+        tree->generate_key = generate_blank_key;
+        tree->free_data    = count_free_data;
+
+        for (i = 0; i < cases[c].n; i++) {
+            data[i] = strdup(cases[c].data[i]);
+            assert(data[i]);
+        }
+
+        freed = 0;
+        n = bee_tree_build_sorted(tree, data, cases[c].n);
+
+        if (n != (ssize_t)cases[c].keys || freed != cases[c].n - cases[c].keys
+            || (!n && tree->root) || check_subtree(tree->root, NULL) < 0)
+            ok = 0;
+
+        printf("%-4s %8zu elements, %zu without key: %zd in tree\n",
+               n == (ssize_t)cases[c].keys ? "ok" : "FAIL", cases[c].n,
+               cases[c].n - cases[c].keys, n);
+
+        bee_tree_free(tree);
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sizes[] = { 1000, 10000, 100000, 1000000 };
+    size_t i;
+    int order, ok = 1;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(*sizes); i++) {
+        for (order = ASCENDING; order <= RANDOM; order++)
+            ok &= run(sizes[i], order);
+    }
+
+    ok &= run_rejected();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
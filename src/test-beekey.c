@@ -0,0 +1,239 @@
+/*
+** test-beekey - check the sort keys against compare_beepackages()
+**
+** Copyright (C) 2009-2016
+**       Marius Tolzmann <m@rius.berlin>
+**       Tobias Dreyer <dreyer@molgen.mpg.de>
+**       and other bee developers
+**
+** This file is part of bee.
+**
+** bee is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "bee_version.h"
+#include "bee_version_parse.h"
+#include "bee_version_compare.h"
+
+#define NPKGS 3000
+
+struct pkg {
+    char              string[128];
+    struct beeversion v;
+    unsigned char     key[256];
+    size_t            length;
+};
+
+static const char *names[]  = { "a", "bee", "bee_dev", "foo", "foo_doc" };
+static const char *extras[] = { "", "_alpha", "_beta", "_rc", "_p", "_a", "_pre" };
+static const char *seps     = "....+";
+
+#define ELEMENTS(a) (sizeof(a) / sizeof(*(a)))
+
+/* a number with up to two leading zeros, mostly small */
+static int put_number(char *s)
+{
+    int zeros = rand() % 4 == 0 ? 1 + rand() % 2 : 0;
+
+    return sprintf(s, "%.*s%d", zeros, "00", rand() % 4 ? rand() % 12 : rand() % 1000);
+}
+
+static void generate(struct pkg *p)
+{
+    char *s = p->string;
+    int i, n;
+
+    s += sprintf(s, "%s-", names[rand() % ELEMENTS(names)]);
+
+    n = 1 + rand() % 4;
+    for (i = 0; i < n; i++) {
+        if (i)
+            *s++ = seps[rand() % strlen(seps)];
+        s += put_number(s);
+        if (rand() % 8 == 0)
+            *s++ = 'a' + rand() % 3;
+    }
+
+    i = rand() % ELEMENTS(extras);
+    s += sprintf(s, "%s", extras[i]);
+    if (i && rand() % 2)
+        s += put_number(s);
+
+    *s++ = '-';
+    s += put_number(s);
+    *s = 0;
+}
+
+static int sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+/* key order of two version strings alone */
+static int compare_version_keys(char *a, char *b)
+{
+    struct beeversion va = { .pkgname = "", .subname = "", .extraversion_nr = "", .pkgrevision = "" };
+    struct beeversion vb = va;
+    unsigned char ka[256], kb[256];
+    size_t la, lb;
+
+    va.version = a;
+    vb.version = b;
+
+    la = encode_beepackage_key(&va, ka, sizeof(ka));
+    lb = encode_beepackage_key(&vb, kb, sizeof(kb));
+    assert(la <= sizeof(ka) && lb <= sizeof(kb));
+
+    return sign(compare_beepackage_keys(ka, la, kb, lb));
+}
+
+/*
+ * RETURN: 1 if compare_version_strings() skips a zero in the middle of a
+ *         number as if it were a leading zero: "205" < "21" < "22" < "205"
+ */
+static int skips_inner_zero(char *v1, char *v2)
+{
+    char *a = v1, *b = v2, *c;
+
+    while (*a && *b && *a == *b) {
+        a++;
+        b++;
+
+        if (*a == *b || !isdigit(*a) || !isdigit(*b))
+            continue;
+
+        for (c = a; *c == '0'; c++)
+            ;
+        if (c != a && isdigit(*c) && isdigit(a[-1]))
+            return 1;
+        if (isdigit(*c))
+            a = c;
+
+        for (c = b; *c == '0'; c++)
+            ;
+        if (c != b && isdigit(*c) && isdigit(b[-1]))
+            return 1;
+        if (isdigit(*c))
+            b = c;
+    }
+
+    return 0;
+}
+
+/*
+ * compare a and b field by field like compare_beepackages()
+ *
+ * RETURN: the order compare_beepackages() gives a and b, or 2 if it
+ *         decides on a field it has no consistent order for: the field
+ *         compares equal although the keys differ, the comparison is
+ *         not antisymmetric or skips zeros inside a number
+ */
+#define UNORDERED 2
+
+static int expected_order(struct beeversion *a, struct beeversion *b)
+{
+    char *fa[] = { a->version, a->extraversion_nr, a->pkgrevision };
+    char *fb[] = { b->version, b->extraversion_nr, b->pkgrevision };
+    int i, old, rev;
+
+    old = sign(compare_beepackage_names(a, b));
+    if (old)
+        return old;
+
+    for (i = 0; i < 3; i++) {
+        if (i == 1 && a->extraversion_typ != b->extraversion_typ)
+            return a->extraversion_typ < b->extraversion_typ ? -1 : 1;
+
+        old = sign(compare_version_strings(fa[i], fb[i]));
+        rev = sign(compare_version_strings(fb[i], fa[i]));
+
+        if (old && old != rev && !skips_inner_zero(fa[i], fb[i]))
+            return old;
+
+        if (old || compare_version_keys(fa[i], fb[i]))
+            return UNORDERED;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct pkg *pkgs;
+    unsigned long pairs = 0, unordered = 0, differ = 0, failed = 0;
+    int old, exp, new;
+    size_t i, j;
+
+    pkgs = calloc(NPKGS, sizeof(*pkgs));
+    assert(pkgs);
+
+    srand(NPKGS);
+
+    for (i = 0; i < NPKGS; i++) {
+        generate(pkgs + i);
+        if (parse_version(pkgs[i].string, &pkgs[i].v) != 0) {
+            fprintf(stderr, "FAIL can't parse %s\n", pkgs[i].string);
+            return EXIT_FAILURE;
+        }
+        pkgs[i].length = encode_beepackage_key(&pkgs[i].v, pkgs[i].key, sizeof(pkgs[i].key));
+        assert(pkgs[i].length <= sizeof(pkgs[i].key));
+    }
+
+    for (i = 0; i < NPKGS; i++) {
+        for (j = i; j < NPKGS; j++) {
+            pairs++;
+
+            old = sign(compare_beepackages(&pkgs[i].v, &pkgs[j].v));
+            exp = expected_order(&pkgs[i].v, &pkgs[j].v);
+            new = sign(compare_beepackage_keys(pkgs[i].key, pkgs[i].length,
+                                               pkgs[j].key, pkgs[j].length));
+
+            if (exp == UNORDERED) {
+                unordered++;
+                if (old != new)
+                    differ++;
+                continue;
+            }
+
+            if (old != exp) {
+                fprintf(stderr, "FAIL %s <=> %s: expected_order() does not match compare_beepackages()\n",
+                        pkgs[i].string, pkgs[j].string);
+                return EXIT_FAILURE;
+            }
+
+            if (old == new)
+                continue;
+
+            if (failed++ < 10)
+                fprintf(stderr, "FAIL %s <=> %s: compare_beepackages %d, keys %d\n",
+                        pkgs[i].string, pkgs[j].string, old, new);
+        }
+    }
+
+    printf("%-4s %lu pairs  %lu unordered by compare_beepackages (%lu keys differ)  %lu mismatches\n",
+           failed ? "FAIL" : "ok", pairs, unordered, differ, failed);
+
+    for (i = 0; i < NPKGS; i++)
+        free(pkgs[i].v.string);
+    free(pkgs);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}